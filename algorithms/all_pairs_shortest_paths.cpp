@@ -0,0 +1,329 @@
+/* This file implements multi-threaded all-pairs shortest paths with path reconstruction. */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "dijkstra.cpp"
+
+/*
+ * All-pairs shortest paths computed on many threads.
+ *
+ * Two modes are available:
+ * floyd_warshall - blocked Floyd-Warshall algorithm on a dense matrix. For every
+ * block of intermediate nodes the diagonal tile is updated first, then tiles in
+ * its row and column in parallel, then all remaining tiles in parallel.
+ * johnson - Johnson's algorithm for sparse graphs. Bellman-Ford (queue-based)
+ * computes potentials that make all costs non-negative, then Dijkstra's
+ * algorithm is run from every source in parallel, O(V * E log V) total.
+ *
+ * Both modes also fill next-hop matrix, so any shortest path can be restored
+ * in time proportional to its length. In floyd_warshall the matrix is rebuilt
+ * from final distances: for every target, nodes are reached by BFS over
+ * reversed edges lying on shortest paths, so next hops follow paths with the
+ * fewest edges and never form a cycle, even with zero-weight cycles.
+ *
+ * Variables
+ * ---------
+ * number_of_nodes - number of nodes in the graph
+ * distance - row-major matrix of distances, INF if there is no path
+ * next_hop - row-major matrix, next_hop[i*n+j] is the node after 'i' on the
+ * shortest path from 'i' to 'j', -1 if there is no path
+ *
+ * Examples
+ * --------
+ * std::vector<int32_t> matrix = {0, 1, INF, INF, 0, -1, 1, INF, 0};
+ * AllPairsShortestPaths paths;
+ * paths.floyd_warshall(matrix, 3, 8);
+ * std::cout << paths.get(0, 2) << "\n";
+ * auto path = paths.path(0, 2);
+ *
+ * std::vector<int32_t> zero_cycle = {0, 0, INF, 0, 0, 5, INF, INF, 0};
+ * paths.floyd_warshall(zero_cycle, 3, 8, 2);
+ * auto through_cycle = paths.path(1, 2);
+ *
+ * CsrGraph graph(3, edges);
+ * paths.johnson(graph, 8);
+ */
+struct AllPairsShortestPaths
+{
+    int32_t number_of_nodes;
+    std::vector<int32_t> distance;
+    std::vector<int32_t> next_hop;
+
+    AllPairsShortestPaths()
+        : number_of_nodes(0)
+    {
+    }
+
+    int32_t get(int32_t from, int32_t to) const
+    {
+        return distance[(int64_t)from * number_of_nodes + to];
+    }
+
+    /* Nodes on the shortest path from 'from' to 'to', empty if there is no path
+     * (or next_hop does not lead to 'to' within number_of_nodes steps).
+     */
+    std::vector<int32_t> path(int32_t from, int32_t to) const
+    {
+        std::vector<int32_t> result;
+        if(next_hop[(int64_t)from * number_of_nodes + to] == -1)
+            return result;
+
+        result.push_back(from);
+        while(from != to)
+        {
+            if((int32_t)result.size() > number_of_nodes)
+                return {};
+
+            from = next_hop[(int64_t)from * number_of_nodes + to];
+            result.push_back(from);
+        }
+
+        return result;
+    }
+
+    /* Run 'function(index)' for every index in [0, count) on 'number_of_threads' threads. */
+    template<class F>
+    static void parallel_for(int32_t count, int32_t number_of_threads, F function)
+    {
+        number_of_threads = std::max(1, std::min(number_of_threads, count));
+        std::atomic<int32_t> next_index(0);
+        auto worker = [&]()
+        {
+            for(int32_t i = next_index++; i < count; i = next_index++)
+                function(i);
+        };
+
+        std::vector<std::thread> threads;
+        for(int32_t i = 1; i < number_of_threads; i++)
+            threads.emplace_back(worker);
+        worker();
+        for(auto& thread: threads)
+            thread.join();
+    }
+
+    /* Min-plus update of tile [i_begin, i_end) x [j_begin, j_end) through nodes [k_begin, k_end). */
+    void update_tile(int32_t i_begin, int32_t i_end, int32_t j_begin, int32_t j_end,
+        int32_t k_begin, int32_t k_end)
+    {
+        int64_t n = number_of_nodes;
+        for(int32_t k = k_begin; k < k_end; k++)
+        {
+            const int32_t* distance_k = distance.data() + k * n;
+            for(int32_t i = i_begin; i < i_end; i++)
+            {
+                int32_t* distance_i = distance.data() + i * n;
+                int32_t via_k = distance_i[k];
+
+                for(int32_t j = j_begin; j < j_end; j++)
+                    distance_i[j] = std::min(distance_i[j], via_k + distance_k[j]);
+            }
+        }
+    }
+
+    /* Compute all-pairs shortest paths with parallel blocked Floyd-Warshall algorithm.
+     *
+     * Parameters
+     * ----------
+     * matrix - graph in contiguous row-major form, INF if there is no edge.
+     * INF + INF must fit in int32_t and every finite path must be shorter than INF/2
+     * dimension - number of nodes in the graph
+     * number_of_threads - number of threads to use
+     * block_size - size of the tile side
+     *
+     * Returns
+     * -------
+     * false if the graph contains a negative cycle, true otherwise
+     */
+    bool floyd_warshall(const std::vector<int32_t>& matrix, int32_t dimension,
+        int32_t number_of_threads=std::thread::hardware_concurrency(), int32_t block_size=64)
+    {
+        number_of_nodes = dimension;
+        distance = matrix;
+        for(int32_t i = 0; i < dimension; i++)
+            distance[(int64_t)i * dimension + i] = std::min(distance[(int64_t)i * dimension + i], 0);
+
+        int32_t number_of_blocks = (dimension + block_size - 1) / block_size;
+        auto block_begin = [&](int32_t block) { return block * block_size; };
+        auto block_end = [&](int32_t block) { return std::min((block + 1) * block_size, dimension); };
+
+        for(int32_t k = 0; k < number_of_blocks; k++)
+        {
+            update_tile(block_begin(k), block_end(k), block_begin(k), block_end(k),
+                block_begin(k), block_end(k));
+
+            parallel_for(2 * number_of_blocks, number_of_threads, [&](int32_t index)
+            {
+                int32_t other = index / 2;
+                if(other == k)
+                    return;
+
+                if(index % 2 == 0)
+                    update_tile(block_begin(k), block_end(k), block_begin(other), block_end(other),
+                        block_begin(k), block_end(k));
+                else
+                    update_tile(block_begin(other), block_end(other), block_begin(k), block_end(k),
+                        block_begin(k), block_end(k));
+            });
+
+            parallel_for(number_of_blocks, number_of_threads, [&](int32_t i)
+            {
+                if(i == k)
+                    return;
+
+                for(int32_t j = 0; j < number_of_blocks; j++)
+                    if(j != k)
+                        update_tile(block_begin(i), block_end(i), block_begin(j), block_end(j),
+                            block_begin(k), block_end(k));
+            });
+        }
+
+        for(int64_t i = 0; i < (int64_t)distance.size(); i++)
+            if(distance[i] > INF / 2)
+                distance[i] = INF;
+
+        for(int32_t i = 0; i < dimension; i++)
+            if(distance[(int64_t)i * dimension + i] < 0)
+                return false;
+
+        build_next_hop(matrix, number_of_threads);
+        return true;
+    }
+
+    /* Fill next_hop from final distances. For every target BFS over reversed
+     * edges (i, v) with matrix[i][v] + distance[v][target] == distance[i][target]
+     * sets next hop of 'i' to the node it was discovered from, so the number
+     * of edges to target strictly decreases along next hops.
+     */
+    void build_next_hop(const std::vector<int32_t>& matrix, int32_t number_of_threads)
+    {
+        int64_t n = number_of_nodes;
+        next_hop.assign(n * n, -1);
+
+        parallel_for(n, number_of_threads, [&](int32_t target)
+        {
+            std::vector<int32_t> to_visit;
+            to_visit.reserve(n);
+            to_visit.push_back(target);
+            next_hop[target * n + target] = target;
+
+            for(int32_t head = 0; head < (int32_t)to_visit.size(); head++)
+            {
+                auto current = to_visit[head];
+                int32_t current_distance = distance[current * n + target];
+                for(int32_t i = 0; i < n; i++)
+                {
+                    int32_t cost = matrix[i * n + current];
+                    if(i == current || cost >= INF || next_hop[i * n + target] != -1)
+                        continue;
+
+                    if(cost + current_distance == distance[i * n + target])
+                    {
+                        next_hop[i * n + target] = current;
+                        to_visit.push_back(i);
+                    }
+                }
+            }
+        });
+    }
+
+    /* Compute all-pairs shortest paths with Johnson's algorithm.
+     *
+     * Parameters
+     * ----------
+     * graph - weighted graph representation using CSR format, costs can be negative
+     * number_of_threads - number of threads running Dijkstra's algorithm
+     *
+     * Returns
+     * -------
+     * false if the graph contains a negative cycle, true otherwise
+     */
+    bool johnson(const CsrGraph& graph, int32_t number_of_threads=std::thread::hardware_concurrency())
+    {
+        int32_t n = graph.number_of_nodes;
+        number_of_nodes = n;
+
+        std::vector<int64_t> potential(n, 0);
+        std::vector<int32_t> path_length(n, 0);
+        std::vector<bool> in_queue(n, true);
+        std::vector<int32_t> to_visit(n);
+        for(int32_t i = 0; i < n; i++)
+            to_visit[i] = i;
+
+        for(int32_t head = 0; head < (int32_t)to_visit.size(); head++)
+        {
+            auto current = to_visit[head];
+            in_queue[current] = false;
+
+            for(int32_t i = graph.offsets[current]; i < graph.offsets[current+1]; i++)
+            {
+                auto to = graph.targets[i];
+                if(potential[to] <= potential[current] + graph.weights[i])
+                    continue;
+
+                potential[to] = potential[current] + graph.weights[i];
+                path_length[to] = path_length[current] + 1;
+                if(path_length[to] >= n)
+                    return false;
+
+                if(!in_queue[to])
+                {
+                    in_queue[to] = true;
+                    to_visit.push_back(to);
+                }
+            }
+
+            if(head > n)
+            {
+                to_visit.erase(to_visit.begin(), to_visit.begin() + head + 1);
+                head = -1;
+            }
+        }
+
+        distance.assign((int64_t)n * n, INF);
+        next_hop.assign((int64_t)n * n, -1);
+
+        parallel_for(n, number_of_threads, [&](int32_t source)
+        {
+            std::vector<int64_t> reduced(n, INT64_MAX);
+            std::vector<int32_t> first_hop(n, -1);
+            std::vector<int32_t> settled;
+            IndexedDaryHeap<int64_t, 4> min_queue(n);
+
+            reduced[source] = 0;
+            first_hop[source] = source;
+            min_queue.push_or_decrease(source, 0);
+
+            while(!min_queue.empty())
+            {
+                auto current = min_queue.pop().first;
+                settled.push_back(current);
+
+                for(int32_t i = graph.offsets[current]; i < graph.offsets[current+1]; i++)
+                {
+                    auto to = graph.targets[i];
+                    auto candidate = reduced[current] + graph.weights[i] + potential[current] - potential[to];
+                    if(candidate < reduced[to])
+                    {
+                        reduced[to] = candidate;
+                        first_hop[to] = (current == source ? to : first_hop[current]);
+                        min_queue.push_or_decrease(to, candidate);
+                    }
+                }
+            }
+
+            int32_t* distance_row = distance.data() + (int64_t)source * n;
+            int32_t* next_row = next_hop.data() + (int64_t)source * n;
+            for(auto node: settled)
+            {
+                distance_row[node] = reduced[node] - potential[source] + potential[node];
+                next_row[node] = first_hop[node];
+            }
+        });
+
+        return true;
+    }
+};
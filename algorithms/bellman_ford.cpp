@@ -1,9 +1,15 @@
 /* This file defines Bellman-Ford algorithm. */
 
+#pragma once
+
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <thread>
 #include <vector>
 
+#include "csr_graph.cpp"
+
 const int32_t INF = 1000'000'005LL;
 
 /*Struct that keeps information about edges in graph*/
@@ -52,3 +58,175 @@ void bellman_ford(std::vector<Edge>& edges, T& distance, int32_t graph_size, int
             break;
     }
 }
+
+/*
+ * Queue-based Bellman-Ford algorithm (SPFA) with negative cycle detection
+ *
+ * Only edges leaving nodes whose distance changed are relaxed again, so on
+ * most graphs it does far less work than relaxing all edges V-1 times. Every
+ * node remembers number of edges on its current shortest path; once it reaches
+ * 'graph_size', parent pointers contain a negative cycle.
+ *
+ * Parameters
+ * ----------
+ * edges - edges in graph
+ * distance - array which keeps distances in the graph. Can be both int[] and vector<int>.
+ * Meaningless if negative cycle was found
+ * graph_size - number of nodes in the graph
+ * starting_point - vertex to start from
+ *
+ * Returns
+ * -------
+ * nodes of a negative cycle reachable from 'starting_point' in order of edges,
+ * empty if there is no such cycle
+ *
+ * Usage
+ * -----
+ * vector<Edge> edges = {{0, 1, 1}, {1, 2, -2}, {2, 1, 1}, {2, 3, 5}};
+ * long long distance[4];
+ * auto cycle = spfa(edges, distance, 4, 0);
+ */
+template<class T>
+std::vector<int32_t> spfa(std::vector<Edge>& edges, T& distance, int32_t graph_size, int32_t starting_point=0)
+{
+    CsrGraph graph(graph_size, edges);
+    std::vector<int32_t> parent(graph_size, -1), path_length(graph_size, 0);
+    std::vector<bool> in_queue(graph_size, false);
+    std::vector<int32_t> to_visit{starting_point};
+
+    for(int32_t i = 0; i < graph_size; i++)
+        distance[i] = INF;
+    distance[starting_point] = 0;
+    in_queue[starting_point] = true;
+
+    for(int32_t head = 0; head < (int32_t)to_visit.size(); head++)
+    {
+        auto current = to_visit[head];
+        in_queue[current] = false;
+
+        for(int32_t i = graph.offsets[current]; i < graph.offsets[current+1]; i++)
+        {
+            auto to = graph.targets[i];
+            if(distance[to] <= distance[current] + graph.weights[i])
+                continue;
+
+            distance[to] = distance[current] + graph.weights[i];
+            parent[to] = current;
+            path_length[to] = path_length[current] + 1;
+
+            if(path_length[to] >= graph_size)
+            {
+                for(int32_t j = 0; j < graph_size; j++)
+                    to = parent[to];
+
+                std::vector<int32_t> cycle{to};
+                for(auto node = parent[to]; node != to; node = parent[node])
+                    cycle.push_back(node);
+
+                std::reverse(cycle.begin(), cycle.end());
+                return cycle;
+            }
+
+            if(!in_queue[to])
+            {
+                in_queue[to] = true;
+                to_visit.push_back(to);
+            }
+        }
+
+        if(head > graph_size)
+        {
+            to_visit.erase(to_visit.begin(), to_visit.begin() + head + 1);
+            head = -1;
+        }
+    }
+
+    return {};
+}
+
+/*
+ * Multi-threaded Bellman-Ford algorithm
+ *
+ * In every round edges are split into equal chunks relaxed in parallel, with
+ * distances lowered by atomic compare-and-swap. Rounds stop as soon as a whole
+ * round changes nothing. If distances still change after 'graph_size'-1 rounds,
+ * the negative cycle is extracted with spfa.
+ *
+ * Parameters
+ * ----------
+ * edges - edges in graph
+ * distance - array which keeps distances in the graph. Can be both int[] and vector<int>.
+ * Meaningless if negative cycle was found
+ * graph_size - number of nodes in the graph
+ * starting_point - vertex to start from
+ * number_of_threads - number of threads to use
+ *
+ * Returns
+ * -------
+ * nodes of a negative cycle reachable from 'starting_point' in order of edges,
+ * empty if there is no such cycle
+ *
+ * Usage
+ * -----
+ * vector<Edge> edges = {{0, 1, -1}, {1, 2, -1}, {0, 3, 2}};
+ * long long distance[4];
+ * auto cycle = parallel_bellman_ford(edges, distance, 4, 0, 8);
+ */
+template<class T>
+std::vector<int32_t> parallel_bellman_ford(std::vector<Edge>& edges, T& distance, int32_t graph_size,
+    int32_t starting_point=0, int32_t number_of_threads=std::thread::hardware_concurrency())
+{
+    number_of_threads = std::max(number_of_threads, 1);
+    std::vector<std::atomic<int64_t> > current_distance(graph_size);
+    for(auto& value: current_distance)
+        value.store(INF, std::memory_order_relaxed);
+    current_distance[starting_point].store(0, std::memory_order_relaxed);
+
+    std::atomic<bool> updated(true);
+    auto relax = [&](int64_t begin, int64_t end)
+    {
+        bool local_updated = false;
+        for(auto j = begin; j < end; j++)
+        {
+            auto from_distance = current_distance[edges[j].from].load(std::memory_order_relaxed);
+            if(from_distance >= INF)
+                continue;
+
+            auto candidate = from_distance + edges[j].cost;
+            auto& to_distance = current_distance[edges[j].to];
+            auto old_distance = to_distance.load(std::memory_order_relaxed);
+            while(candidate < old_distance)
+                if(to_distance.compare_exchange_weak(old_distance, candidate, std::memory_order_relaxed))
+                {
+                    local_updated = true;
+                    break;
+                }
+        }
+
+        if(local_updated)
+            updated.store(true, std::memory_order_relaxed);
+    };
+
+    int64_t number_of_edges = edges.size();
+    int32_t round = 0;
+    for(; round < graph_size && updated.load(); round++)
+    {
+        updated.store(false);
+
+        std::vector<std::thread> threads;
+        for(int32_t i = 1; i < number_of_threads; i++)
+            threads.emplace_back(relax, number_of_edges * i / number_of_threads,
+                number_of_edges * (i+1) / number_of_threads);
+        relax(0, number_of_edges / number_of_threads);
+        for(auto& thread: threads)
+            thread.join();
+    }
+
+    if(round == graph_size && updated.load())
+        return spfa(edges, distance, graph_size, starting_point);
+
+    for(int32_t i = 0; i < graph_size; i++)
+        distance[i] = current_distance[i].load(std::memory_order_relaxed);
+
+    return {};
+}
@@ -1,9 +1,35 @@
 /* This file defines BFS algorithm. */
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
 #include <cstdint>
 #include <queue>
+#include <thread>
 #include <vector>
 
+#include "csr_graph.cpp"
+
+/*
+ * Struct that holds result of BFS.
+ *
+ * Variables
+ * ---------
+ * distance - number of edges on the shortest path from starting node, -1 if node is unreachable
+ * parent - previous node on the shortest path from starting node, -1 if node is unreachable.
+ * Parent of starting node is starting node
+ */
+struct BfsResult
+{
+    std::vector<int32_t> distance;
+    std::vector<int32_t> parent;
+
+    BfsResult(int32_t number_of_nodes=0)
+        : distance(number_of_nodes, -1), parent(number_of_nodes, -1)
+    {
+    }
+};
+
 /*
  * Standard BFS algorithm that traverses through the whole graph described in 'nodes' variable.
  *
@@ -11,18 +37,23 @@
  * ----------
  * nodes - graph representation using adjacency list format
  * starting_node - id of the node to start BFS from
- * 
+ *
+ * Returns
+ * -------
+ * distances and parents of all nodes, see BfsResult
+ *
  * Examples
  * --------
  * std::vector<std::vector<int> > graph{{1}, {2}, {0}};
- * bfs(graph, 0);
+ * auto result = bfs(graph, 0);
  */
-void bfs(std::vector<std::vector<int32_t> >& nodes, int32_t starting_node)
+BfsResult bfs(std::vector<std::vector<int32_t> >& nodes, int32_t starting_node)
 {
-    std::vector<bool> visited(nodes.size(), 0);
+    BfsResult result(nodes.size());
     std::queue<int32_t> to_visit;
 
-    visited[starting_node] = true;
+    result.distance[starting_node] = 0;
+    result.parent[starting_node] = starting_node;
     to_visit.push(starting_node);
 
     while(!to_visit.empty())
@@ -31,10 +62,311 @@ void bfs(std::vector<std::vector<int32_t> >& nodes, int32_t starting_node)
         to_visit.pop();
 
         for(auto& neighbour: nodes[current])
-            if(!visited[neighbour])
+            if(result.distance[neighbour] == -1)
             {
-                visited[neighbour] = true;
+                result.distance[neighbour] = result.distance[current] + 1;
+                result.parent[neighbour] = current;
                 to_visit.push(neighbour);
             }
     }
-}
\ No newline at end of file
+
+    return result;
+}
+
+/*
+ * BFS algorithm that traverses through the whole graph stored in CSR format.
+ *
+ * Parameters
+ * ----------
+ * graph - graph representation using CSR format
+ * starting_node - id of the node to start BFS from
+ *
+ * Returns
+ * -------
+ * distances and parents of all nodes, see BfsResult
+ *
+ * Examples
+ * --------
+ * CsrGraph graph(std::vector<std::vector<int32_t> >{{1}, {2}, {0}});
+ * auto result = bfs(graph, 0);
+ */
+BfsResult bfs(const CsrGraph& graph, int32_t starting_node)
+{
+    BfsResult result(graph.number_of_nodes);
+    std::vector<int32_t> to_visit;
+    to_visit.reserve(graph.number_of_nodes);
+
+    result.distance[starting_node] = 0;
+    result.parent[starting_node] = starting_node;
+    to_visit.push_back(starting_node);
+
+    for(int32_t head = 0; head < (int32_t)to_visit.size(); head++)
+    {
+        auto current = to_visit[head];
+
+        for(int32_t i = graph.offsets[current]; i < graph.offsets[current+1]; i++)
+        {
+            auto neighbour = graph.targets[i];
+            if(result.distance[neighbour] == -1)
+            {
+                result.distance[neighbour] = result.distance[current] + 1;
+                result.parent[neighbour] = current;
+                to_visit.push_back(neighbour);
+            }
+        }
+    }
+
+    return result;
+}
+
+/*
+ * Direction-optimizing BFS (Beamer et al.) for graphs stored in CSR format.
+ *
+ * Small frontiers are expanded top-down (frontier nodes scan their outgoing
+ * edges). Once the frontier has more outgoing edges than 1/'alpha' of edges of
+ * still unvisited nodes, BFS switches to bottom-up steps, in which every
+ * unvisited node scans its incoming edges and stops at the first parent found
+ * in the frontier bitmap. When the frontier shrinks below 1/'beta' of all
+ * nodes, BFS switches back to top-down steps. On low-diameter graphs this
+ * skips most edge inspections of the largest levels.
+ *
+ * Distances are the same as in standard BFS, parents form a valid BFS tree
+ * but may differ from the ones chosen by standard BFS.
+ *
+ * Parameters
+ * ----------
+ * graph - graph representation using CSR format
+ * transposed - 'graph' with reversed edges. For undirected graphs it is 'graph' itself
+ * starting_node - id of the node to start BFS from
+ * alpha - top-down to bottom-up switching parameter
+ * beta - bottom-up to top-down switching parameter
+ *
+ * Returns
+ * -------
+ * distances and parents of all nodes, see BfsResult
+ *
+ * Examples
+ * --------
+ * std::vector<std::pair<int32_t, int32_t> > edges{{0, 1}, {1, 2}, {2, 0}};
+ * CsrGraph graph(3, edges);
+ * auto result = direction_optimizing_bfs(graph, graph.transposed(), 0);
+ */
+BfsResult direction_optimizing_bfs(const CsrGraph& graph, const CsrGraph& transposed,
+    int32_t starting_node, int32_t alpha=15, int32_t beta=18)
+{
+    int32_t number_of_nodes = graph.number_of_nodes;
+    BfsResult result(number_of_nodes);
+
+    std::vector<int32_t> frontier{starting_node};
+    std::vector<int32_t> next_frontier;
+    std::vector<uint64_t> frontier_bitmap((number_of_nodes + 63) / 64);
+    std::vector<uint64_t> next_bitmap((number_of_nodes + 63) / 64);
+
+    result.distance[starting_node] = 0;
+    result.parent[starting_node] = starting_node;
+
+    int64_t unexplored_edges = graph.number_of_edges() - graph.degree(starting_node);
+    int64_t frontier_edges = graph.degree(starting_node);
+    int32_t frontier_size = 1;
+    bool bottom_up = false;
+
+    for(int32_t level = 0; frontier_size > 0; level++)
+    {
+        if(!bottom_up && frontier_edges > unexplored_edges / alpha)
+        {
+            std::fill(frontier_bitmap.begin(), frontier_bitmap.end(), 0);
+            for(auto node: frontier)
+                frontier_bitmap[node >> 6] |= 1ULL << (node & 63);
+            bottom_up = true;
+        }
+        else if(bottom_up && frontier_size < number_of_nodes / beta)
+        {
+            frontier.clear();
+            for(int32_t node = 0; node < number_of_nodes; node++)
+                if(frontier_bitmap[node >> 6] >> (node & 63) & 1)
+                    frontier.push_back(node);
+            bottom_up = false;
+        }
+
+        frontier_size = 0;
+        frontier_edges = 0;
+
+        if(bottom_up)
+        {
+            std::fill(next_bitmap.begin(), next_bitmap.end(), 0);
+            for(int32_t node = 0; node < number_of_nodes; node++)
+            {
+                if(result.distance[node] != -1)
+                    continue;
+
+                for(int32_t i = transposed.offsets[node]; i < transposed.offsets[node+1]; i++)
+                {
+                    auto parent = transposed.targets[i];
+                    if(frontier_bitmap[parent >> 6] >> (parent & 63) & 1)
+                    {
+                        result.distance[node] = level + 1;
+                        result.parent[node] = parent;
+                        next_bitmap[node >> 6] |= 1ULL << (node & 63);
+                        frontier_size++;
+                        frontier_edges += graph.degree(node);
+                        break;
+                    }
+                }
+            }
+            std::swap(frontier_bitmap, next_bitmap);
+        }
+        else
+        {
+            next_frontier.clear();
+            for(auto current: frontier)
+                for(int32_t i = graph.offsets[current]; i < graph.offsets[current+1]; i++)
+                {
+                    auto neighbour = graph.targets[i];
+                    if(result.distance[neighbour] == -1)
+                    {
+                        result.distance[neighbour] = level + 1;
+                        result.parent[neighbour] = current;
+                        next_frontier.push_back(neighbour);
+                        frontier_edges += graph.degree(neighbour);
+                    }
+                }
+            frontier_size = next_frontier.size();
+            std::swap(frontier, next_frontier);
+        }
+
+        unexplored_edges -= frontier_edges;
+    }
+
+    return result;
+}
+
+/*
+ * Multi-threaded level-synchronous BFS for graphs stored in CSR format.
+ *
+ * Every level is processed in two parallel phases over contiguous chunks of
+ * the frontier, balanced by number of outgoing edges. In the first phase every
+ * unvisited neighbour is claimed with atomic compare-and-swap that keeps the
+ * smallest frontier position reaching it. In the second phase only the owner
+ * of the claim visits the node and appends it to its thread-local next
+ * frontier. Local frontiers are concatenated in chunk order, so distances,
+ * parents and visiting order are exactly the same as in sequential bfs().
+ *
+ * Parameters
+ * ----------
+ * graph - graph representation using CSR format
+ * starting_node - id of the node to start BFS from
+ * number_of_threads - number of threads to use
+ * grain - frontiers with fewer outgoing edges are processed by the calling thread only
+ *
+ * Returns
+ * -------
+ * distances and parents of all nodes, see BfsResult
+ *
+ * Examples
+ * --------
+ * std::vector<std::pair<int32_t, int32_t> > edges{{0, 1}, {1, 2}, {2, 0}};
+ * CsrGraph graph(3, edges);
+ * auto result = parallel_bfs(graph, 0, 4);
+ */
+BfsResult parallel_bfs(const CsrGraph& graph, int32_t starting_node,
+    int32_t number_of_threads=std::thread::hardware_concurrency(), int64_t grain=1 << 14)
+{
+    int32_t number_of_nodes = graph.number_of_nodes;
+    number_of_threads = std::max(number_of_threads, 1);
+
+    BfsResult result(number_of_nodes);
+    std::vector<std::atomic<int32_t> > owner(number_of_nodes);
+    for(auto& claim: owner)
+        claim.store(INT32_MAX, std::memory_order_relaxed);
+
+    std::vector<int32_t> frontier{starting_node};
+    std::vector<std::vector<int32_t> > local_frontiers(number_of_threads);
+    std::vector<int32_t> chunk_begin(number_of_threads+1);
+
+    result.distance[starting_node] = 0;
+    result.parent[starting_node] = starting_node;
+
+    auto claim_neighbours = [&](int32_t begin, int32_t end)
+    {
+        for(int32_t position = begin; position < end; position++)
+        {
+            auto current = frontier[position];
+            for(int32_t i = graph.offsets[current]; i < graph.offsets[current+1]; i++)
+            {
+                auto neighbour = graph.targets[i];
+                if(result.distance[neighbour] != -1)
+                    continue;
+
+                auto claim = owner[neighbour].load(std::memory_order_relaxed);
+                while(position < claim && !owner[neighbour].compare_exchange_weak(
+                    claim, position, std::memory_order_relaxed));
+            }
+        }
+    };
+
+    auto visit_claimed = [&](int32_t begin, int32_t end, int32_t level, std::vector<int32_t>& next)
+    {
+        next.clear();
+        for(int32_t position = begin; position < end; position++)
+        {
+            auto current = frontier[position];
+            for(int32_t i = graph.offsets[current]; i < graph.offsets[current+1]; i++)
+            {
+                auto neighbour = graph.targets[i];
+                if(owner[neighbour].load(std::memory_order_relaxed) == position
+                    && result.distance[neighbour] == -1)
+                {
+                    result.distance[neighbour] = level + 1;
+                    result.parent[neighbour] = current;
+                    next.push_back(neighbour);
+                }
+            }
+        }
+    };
+
+    for(int32_t level = 0; !frontier.empty(); level++)
+    {
+        int64_t frontier_edges = 0;
+        for(auto node: frontier)
+            frontier_edges += graph.degree(node);
+
+        int32_t number_of_chunks = std::min<int64_t>(number_of_threads, frontier_edges / grain + 1);
+        chunk_begin[0] = 0;
+        int64_t edges_so_far = 0;
+        for(int32_t position = 0, chunk = 1; chunk < number_of_chunks; chunk++)
+        {
+            while(position < (int32_t)frontier.size()
+                && edges_so_far * number_of_chunks < frontier_edges * chunk)
+                edges_so_far += graph.degree(frontier[position++]);
+            chunk_begin[chunk] = position;
+        }
+        chunk_begin[number_of_chunks] = frontier.size();
+
+        if(number_of_chunks == 1)
+        {
+            claim_neighbours(0, frontier.size());
+            visit_claimed(0, frontier.size(), level, local_frontiers[0]);
+        }
+        else
+        {
+            std::vector<std::thread> threads;
+            for(int32_t chunk = 0; chunk < number_of_chunks; chunk++)
+                threads.emplace_back(claim_neighbours, chunk_begin[chunk], chunk_begin[chunk+1]);
+            for(auto& thread: threads)
+                thread.join();
+
+            threads.clear();
+            for(int32_t chunk = 0; chunk < number_of_chunks; chunk++)
+                threads.emplace_back(visit_claimed, chunk_begin[chunk], chunk_begin[chunk+1],
+                    level, std::ref(local_frontiers[chunk]));
+            for(auto& thread: threads)
+                thread.join();
+        }
+
+        frontier.clear();
+        for(int32_t chunk = 0; chunk < number_of_chunks; chunk++)
+            frontier.insert(frontier.end(), local_frontiers[chunk].begin(), local_frontiers[chunk].end());
+    }
+
+    return result;
+}
@@ -0,0 +1,352 @@
+/* This file implements contraction hierarchies for repeated shortest path queries. */
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dijkstra.cpp"
+
+/*
+ * Contraction hierarchies.
+ *
+ * Preprocessing contracts nodes one by one in order of increasing importance
+ * (edge difference + number of already contracted neighbours, updated lazily).
+ * When node 'v' is contracted, for every pair of remaining neighbours u -> v -> w
+ * a local witness search from 'u' that avoids 'v' checks whether there is
+ * another path not longer than u -> v -> w, and if not, shortcut u -> w is
+ * added. Node's position in this order is its rank.
+ *
+ * Query runs Dijkstra's algorithm from the source on edges going up in rank and
+ * from the target on reversed edges going up in rank, and stops each direction
+ * once its smallest key reaches the best meeting found. Both searches stay in
+ * small upper part of the hierarchy, so a query touches few hundreds of nodes
+ * on road-like graphs instead of the whole graph.
+ *
+ * Preprocessed hierarchy can be saved to and loaded from a binary file.
+ *
+ * Variables
+ * ---------
+ * upward - edges u -> w with rank[u] < rank[w], including shortcuts
+ * downward - reversed edges w -> u for edges u -> w with rank[u] > rank[w], including shortcuts
+ * rank - position of the node in the contraction order
+ *
+ * Examples
+ * --------
+ * ContractionHierarchy hierarchy(graph);
+ * hierarchy.save("graph.ch");
+ *
+ * ContractionHierarchy loaded;
+ * loaded.load("graph.ch");
+ * std::cout << loaded.query(0, 3) << "\n";
+ */
+struct ContractionHierarchy
+{
+    CsrGraph upward;
+    CsrGraph downward;
+    std::vector<int32_t> rank;
+    DijkstraWorkspace forward;
+    DijkstraWorkspace backward;
+
+    ContractionHierarchy()
+    {
+    }
+
+    ContractionHierarchy(const CsrGraph& graph, int32_t witness_search_limit=500)
+    {
+        build(graph, witness_search_limit);
+    }
+
+    /* Contract all nodes of the graph.
+     *
+     * Parameters
+     * ----------
+     * graph - weighted graph representation using CSR format, costs must be non-negative
+     * witness_search_limit - maximal number of nodes settled by one witness search.
+     * Smaller values make preprocessing faster but add unnecessary shortcuts.
+     * Node priorities are estimated with 1/10 of this limit
+     */
+    void build(const CsrGraph& graph, int32_t witness_search_limit=500)
+    {
+        int32_t number_of_nodes = graph.number_of_nodes;
+        std::vector<std::vector<std::pair<int32_t, int32_t> > > out(number_of_nodes), in(number_of_nodes);
+
+        auto add_edge = [&](int32_t from, int32_t to, int32_t cost)
+        {
+            for(auto& edge: out[from])
+                if(edge.first == to)
+                {
+                    if(cost < edge.second)
+                    {
+                        edge.second = cost;
+                        for(auto& reversed: in[to])
+                            if(reversed.first == from)
+                                reversed.second = cost;
+                    }
+                    return;
+                }
+
+            out[from].push_back({to, cost});
+            in[to].push_back({from, cost});
+        };
+
+        for(int32_t from = 0; from < number_of_nodes; from++)
+            for(int32_t i = graph.offsets[from]; i < graph.offsets[from+1]; i++)
+                if(graph.targets[i] != from)
+                    add_edge(from, graph.targets[i], graph.weights[i]);
+
+        std::vector<int32_t> contracted_neighbours(number_of_nodes, 0);
+        int32_t simulation_limit = std::max(1, witness_search_limit / 10);
+
+        std::vector<int32_t> witness_distance(number_of_nodes);
+        std::vector<uint32_t> witness_generation_of(number_of_nodes, 0);
+        uint32_t witness_generation = 0;
+        std::vector<int32_t> target_of(number_of_nodes, -1);
+        int32_t number_of_targets = 0;
+        IndexedDaryHeap<int32_t, 4> witness_queue(number_of_nodes);
+
+        auto witness_search = [&](int32_t source, int32_t avoided, int32_t max_cost, int32_t limit)
+        {
+            witness_generation++;
+            witness_generation_of[source] = witness_generation;
+            witness_distance[source] = 0;
+            witness_queue.push_or_decrease(source, 0);
+
+            int32_t remaining_targets = number_of_targets;
+            for(int32_t settled = 0; !witness_queue.empty() && settled < limit; settled++)
+            {
+                auto current = witness_queue.pop();
+                if(current.second > max_cost)
+                    break;
+                if(target_of[current.first] == avoided && --remaining_targets == 0)
+                    break;
+
+                for(auto& edge: out[current.first])
+                {
+                    if(edge.first == avoided)
+                        continue;
+
+                    auto candidate = current.second + edge.second;
+                    if(witness_generation_of[edge.first] != witness_generation
+                        || candidate < witness_distance[edge.first])
+                    {
+                        witness_generation_of[edge.first] = witness_generation;
+                        witness_distance[edge.first] = candidate;
+                        witness_queue.push_or_decrease(edge.first, candidate);
+                    }
+                }
+            }
+
+            witness_queue.clear();
+        };
+
+        auto for_each_shortcut = [&](int32_t node, int32_t limit, auto callback)
+        {
+            int32_t max_out_cost = 0;
+            for(auto& edge: out[node])
+            {
+                max_out_cost = std::max(max_out_cost, edge.second);
+                target_of[edge.first] = node;
+            }
+            number_of_targets = out[node].size();
+
+            for(auto& incoming: in[node])
+            {
+                witness_search(incoming.first, node, incoming.second + max_out_cost, limit);
+                for(auto& outgoing: out[node])
+                {
+                    if(outgoing.first == incoming.first)
+                        continue;
+
+                    auto cost = incoming.second + outgoing.second;
+                    if(witness_generation_of[outgoing.first] != witness_generation
+                        || witness_distance[outgoing.first] > cost)
+                        callback(incoming.first, outgoing.first, cost);
+                }
+            }
+        };
+
+        auto priority = [&](int32_t node)
+        {
+            int32_t shortcuts = 0;
+            for_each_shortcut(node, simulation_limit, [&](int32_t, int32_t, int32_t) { shortcuts++; });
+
+            return shortcuts - (int32_t)(out[node].size() + in[node].size()) + contracted_neighbours[node];
+        };
+
+        auto erase_edge = [&](std::vector<std::pair<int32_t, int32_t> >& edges, int32_t to)
+        {
+            for(auto& edge: edges)
+                if(edge.first == to)
+                {
+                    edge = edges.back();
+                    edges.pop_back();
+                    return;
+                }
+        };
+
+        IndexedDaryHeap<int32_t, 4> order(number_of_nodes);
+        for(int32_t node = 0; node < number_of_nodes; node++)
+            order.push_or_decrease(node, priority(node));
+
+        struct HierarchyEdge
+        {
+            int32_t from;
+            int32_t to;
+            int32_t cost;
+        };
+
+        std::vector<HierarchyEdge> upward_edges, downward_edges;
+        std::vector<HierarchyEdge> shortcuts;
+        rank.assign(number_of_nodes, 0);
+        for(int32_t next_rank = 0; !order.empty();)
+        {
+            auto node = order.pop().first;
+            auto current_priority = priority(node);
+            if(!order.empty() && current_priority > order.key[order.heap[0]])
+            {
+                order.push_or_decrease(node, current_priority);
+                continue;
+            }
+
+            shortcuts.clear();
+            for_each_shortcut(node, witness_search_limit, [&](int32_t from, int32_t to, int32_t cost)
+            {
+                shortcuts.push_back({from, to, cost});
+            });
+            for(auto& shortcut: shortcuts)
+                add_edge(shortcut.from, shortcut.to, shortcut.cost);
+
+            rank[node] = next_rank++;
+            for(auto& edge: out[node])
+            {
+                upward_edges.push_back({node, edge.first, edge.second});
+                erase_edge(in[edge.first], node);
+                contracted_neighbours[edge.first]++;
+            }
+            for(auto& edge: in[node])
+            {
+                downward_edges.push_back({node, edge.first, edge.second});
+                erase_edge(out[edge.first], node);
+                contracted_neighbours[edge.first]++;
+            }
+            out[node].clear();
+            out[node].shrink_to_fit();
+            in[node].clear();
+            in[node].shrink_to_fit();
+        }
+
+        upward = CsrGraph(number_of_nodes, upward_edges);
+        downward = CsrGraph(number_of_nodes, downward_edges);
+        forward = DijkstraWorkspace(number_of_nodes);
+        backward = DijkstraWorkspace(number_of_nodes);
+    }
+
+    /* Length of the shortest path from 'source' to 'target', INF if there is no path. */
+    int32_t query(int32_t source, int32_t target)
+    {
+        int32_t best = INF;
+        forward.start({source});
+        backward.start({target});
+
+        while(std::min(forward.top_key(), backward.top_key()) < best)
+        {
+            bool is_forward = forward.top_key() <= backward.top_key();
+            auto& side = (is_forward ? forward : backward);
+            auto& other = (is_forward ? backward : forward);
+
+            auto current = side.settle_next(is_forward ? upward : downward);
+            if(other.distance(current) < INF)
+                best = std::min(best, side.distance(current) + other.distance(current));
+        }
+
+        forward.finish();
+        backward.finish();
+        return best;
+    }
+
+    /* Save preprocessed hierarchy to binary file. Returns false on failure. */
+    bool save(const std::string& filename) const
+    {
+        std::ofstream file(filename, std::ios::binary);
+
+        auto write_vector = [&](const std::vector<int32_t>& values)
+        {
+            int64_t size = values.size();
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            file.write(reinterpret_cast<const char*>(values.data()), size * sizeof(int32_t));
+        };
+
+        write_vector(rank);
+        write_vector(upward.offsets);
+        write_vector(upward.targets);
+        write_vector(upward.weights);
+        write_vector(downward.offsets);
+        write_vector(downward.targets);
+        write_vector(downward.weights);
+
+        return (bool)file;
+    }
+
+    /* Check that 'graph' is consistent CSR over 'number_of_nodes' nodes. */
+    static bool valid_csr(const CsrGraph& graph, int32_t number_of_nodes)
+    {
+        if((int64_t)graph.offsets.size() != (int64_t)number_of_nodes+1 || graph.offsets[0] != 0)
+            return false;
+
+        for(int32_t i = 0; i < number_of_nodes; i++)
+            if(graph.offsets[i] > graph.offsets[i+1])
+                return false;
+
+        if((int64_t)graph.targets.size() != graph.offsets.back()
+            || graph.weights.size() != graph.targets.size())
+            return false;
+
+        for(auto target: graph.targets)
+            if(target < 0 || target >= number_of_nodes)
+                return false;
+
+        return true;
+    }
+
+    /* Load hierarchy saved with save(). Returns false on failure, including
+     * truncated files and edge arrays that are inconsistent with each other.
+     */
+    bool load(const std::string& filename)
+    {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        int64_t remaining = file ? (int64_t)file.tellg() : 0;
+        file.seekg(0);
+
+        auto read_vector = [&](std::vector<int32_t>& values)
+        {
+            int64_t size = 0;
+            file.read(reinterpret_cast<char*>(&size), sizeof(size));
+            remaining -= sizeof(size);
+            if(!file || size < 0 || size > remaining / (int64_t)sizeof(int32_t))
+                return false;
+
+            remaining -= size * sizeof(int32_t);
+
+            values.resize(size);
+            file.read(reinterpret_cast<char*>(values.data()), size * sizeof(int32_t));
+            return (bool)file;
+        };
+
+        if(!read_vector(rank) || !read_vector(upward.offsets) || !read_vector(upward.targets)
+            || !read_vector(upward.weights) || !read_vector(downward.offsets)
+            || !read_vector(downward.targets) || !read_vector(downward.weights))
+            return false;
+
+        int32_t number_of_nodes = rank.size();
+        if(!valid_csr(upward, number_of_nodes) || !valid_csr(downward, number_of_nodes))
+            return false;
+
+        upward.number_of_nodes = downward.number_of_nodes = number_of_nodes;
+        forward = DijkstraWorkspace(number_of_nodes);
+        backward = DijkstraWorkspace(number_of_nodes);
+        return true;
+    }
+};
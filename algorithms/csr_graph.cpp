@@ -0,0 +1,200 @@
+/* This file defines graph stored in compressed sparse row (CSR) format. */
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+ * Graph stored in compressed sparse row format.
+ *
+ * Neighbours of node 'v' are stored contiguously in 'targets' (and 'weights')
+ * on positions [offsets[v], offsets[v+1]), so scanning adjacency list is a
+ * sequential read from a single allocation instead of pointer chasing through
+ * one vector per node.
+ *
+ * Variables
+ * ---------
+ * number_of_nodes - number of nodes in the graph
+ * offsets - array of size 'number_of_nodes'+1 with start of every adjacency list
+ * targets - ends of the edges, grouped by the start of the edge
+ * weights - costs of the edges, parallel to 'targets'. Empty for unweighted graphs
+ *
+ * Examples
+ * --------
+ * std::vector<std::pair<int32_t, int32_t> > edges{{0, 1}, {1, 2}, {2, 0}};
+ * CsrGraph graph(3, edges);
+ * for(int32_t i = graph.offsets[0]; i < graph.offsets[1]; i++)
+ *     std::cout << graph.targets[i] << "\n";
+ */
+struct CsrGraph
+{
+    int32_t number_of_nodes;
+    std::vector<int32_t> offsets;
+    std::vector<int32_t> targets;
+    std::vector<int32_t> weights;
+
+    CsrGraph(int32_t number_of_nodes=0)
+        : number_of_nodes(number_of_nodes), offsets(number_of_nodes+1, 0)
+    {
+    }
+
+    /* Build unweighted graph from edge list in two counting passes.
+     *
+     * Parameters
+     * ----------
+     * number_of_nodes - number of nodes in the graph
+     * edges - list of (from, to) pairs
+     * undirected - if true, every edge is also added in the opposite direction
+     */
+    CsrGraph(int32_t number_of_nodes, const std::vector<std::pair<int32_t, int32_t> >& edges,
+        bool undirected=false)
+        : number_of_nodes(number_of_nodes), offsets(number_of_nodes+1, 0)
+    {
+        for(auto& edge: edges)
+        {
+            offsets[edge.first+1]++;
+            if(undirected)
+                offsets[edge.second+1]++;
+        }
+        for(int32_t i = 0; i < number_of_nodes; i++)
+            offsets[i+1] += offsets[i];
+
+        targets.resize(offsets[number_of_nodes]);
+        std::vector<int32_t> cursor(offsets.begin(), offsets.end()-1);
+        for(auto& edge: edges)
+        {
+            targets[cursor[edge.first]++] = edge.second;
+            if(undirected)
+                targets[cursor[edge.second]++] = edge.first;
+        }
+    }
+
+    /* Build weighted graph from edge list in two counting passes.
+     *
+     * Parameters
+     * ----------
+     * number_of_nodes - number of nodes in the graph
+     * edges - list of edges. Edge type must have 'from', 'to' and 'cost' fields
+     * (e.g. Edge from bellman_ford.cpp)
+     * undirected - if true, every edge is also added in the opposite direction
+     *
+     * Examples
+     * --------
+     * std::vector<Edge> edges = {{0, 1, 1}, {0, 2, 4}, {1, 2, 2}};
+     * CsrGraph graph(3, edges);
+     */
+    template<class E>
+    CsrGraph(int32_t number_of_nodes, const std::vector<E>& edges, bool undirected=false)
+        : number_of_nodes(number_of_nodes), offsets(number_of_nodes+1, 0)
+    {
+        for(auto& edge: edges)
+        {
+            offsets[edge.from+1]++;
+            if(undirected)
+                offsets[edge.to+1]++;
+        }
+        for(int32_t i = 0; i < number_of_nodes; i++)
+            offsets[i+1] += offsets[i];
+
+        targets.resize(offsets[number_of_nodes]);
+        weights.resize(offsets[number_of_nodes]);
+        std::vector<int32_t> cursor(offsets.begin(), offsets.end()-1);
+        for(auto& edge: edges)
+        {
+            targets[cursor[edge.from]] = edge.to;
+            weights[cursor[edge.from]++] = edge.cost;
+            if(undirected)
+            {
+                targets[cursor[edge.to]] = edge.from;
+                weights[cursor[edge.to]++] = edge.cost;
+            }
+        }
+    }
+
+    /* Build unweighted graph from adjacency list.
+     *
+     * Parameters
+     * ----------
+     * nodes - graph representation using adjacency list format
+     */
+    CsrGraph(const std::vector<std::vector<int32_t> >& nodes)
+        : number_of_nodes(nodes.size()), offsets(nodes.size()+1, 0)
+    {
+        for(int32_t i = 0; i < number_of_nodes; i++)
+            offsets[i+1] = offsets[i] + nodes[i].size();
+
+        targets.reserve(offsets[number_of_nodes]);
+        for(auto& neighbours: nodes)
+            targets.insert(targets.end(), neighbours.begin(), neighbours.end());
+    }
+
+    /* Build weighted graph from adjacency list.
+     *
+     * Parameters
+     * ----------
+     * nodes - graph representation using adjacency list format. Edge type
+     * must have 'to' and 'cost' fields (e.g. Edge from dijkstra.cpp)
+     */
+    template<class E>
+    CsrGraph(const std::vector<std::vector<E> >& nodes)
+        : number_of_nodes(nodes.size()), offsets(nodes.size()+1, 0)
+    {
+        for(int32_t i = 0; i < number_of_nodes; i++)
+            offsets[i+1] = offsets[i] + nodes[i].size();
+
+        targets.reserve(offsets[number_of_nodes]);
+        weights.reserve(offsets[number_of_nodes]);
+        for(auto& neighbours: nodes)
+            for(auto& edge: neighbours)
+            {
+                targets.push_back(edge.to);
+                weights.push_back(edge.cost);
+            }
+    }
+
+    /* Graph with every edge reversed, built in two counting passes.
+     *
+     * Returns
+     * -------
+     * graph with edge (a, b, cost) for every edge (b, a, cost) of this graph
+     */
+    CsrGraph transposed() const
+    {
+        CsrGraph result(number_of_nodes);
+        for(auto target: targets)
+            result.offsets[target+1]++;
+        for(int32_t i = 0; i < number_of_nodes; i++)
+            result.offsets[i+1] += result.offsets[i];
+
+        result.targets.resize(targets.size());
+        result.weights.resize(weights.size());
+        std::vector<int32_t> cursor(result.offsets.begin(), result.offsets.end()-1);
+        for(int32_t from = 0; from < number_of_nodes; from++)
+            for(int32_t i = offsets[from]; i < offsets[from+1]; i++)
+            {
+                auto position = cursor[targets[i]]++;
+                result.targets[position] = from;
+                if(is_weighted())
+                    result.weights[position] = weights[i];
+            }
+
+        return result;
+    }
+
+    bool is_weighted() const
+    {
+        return !weights.empty();
+    }
+
+    int32_t number_of_edges() const
+    {
+        return targets.size();
+    }
+
+    int32_t degree(int32_t node) const
+    {
+        return offsets[node+1] - offsets[node];
+    }
+};
@@ -1,8 +1,13 @@
 /* This file defines DFS-like algorithms. */
 
+#pragma once
+
 #include <cstdint>
+#include <utility>
 #include <vector>
 
+#include "csr_graph.cpp"
+
 /*
  * Standard DFS algorithm that traverses through the whole graph described in 'nodes' variable.
  *
@@ -48,4 +53,169 @@ void dfs_on_tree(std::vector<std::vector<int32_t> >& nodes, int32_t current, int
     for(auto& child: nodes[current])
         if(child != parent)
             dfs_on_tree(nodes, child, current);
-}
\ No newline at end of file
+}
+
+/*
+ * DFS algorithm that traverses through the whole graph stored in CSR format.
+ *
+ * Parameters
+ * ----------
+ * graph - graph representation using CSR format
+ * current - id of the currently visited node
+ * visited - array with i-th element being true if i-th node has already
+ * been visited and false otherwise. Can be both vector<bool>, bitset or bool[]
+ *
+ * Examples
+ * --------
+ * CsrGraph graph(std::vector<std::vector<int32_t> >{{1}, {2}, {0}});
+ * bool visited[3] = {0, 0, 0};
+ * dfs(graph, 0, visited);
+ */
+template<class T>
+void dfs(const CsrGraph& graph, int32_t current, T& visited)
+{
+    visited[current] = true;
+    for(int32_t i = graph.offsets[current]; i < graph.offsets[current+1]; i++)
+        if(!visited[graph.targets[i]])
+            dfs(graph, graph.targets[i], visited);
+}
+
+
+/*
+ * DFS algorithm that traverses tree-like graphs stored in CSR format.
+ *
+ * Attributes
+ * ----------
+ * graph - tree representation using CSR format
+ * current - id of the currently visited node
+ * parent - id of the previously visited node
+ *
+ * Examples
+ * --------
+ * CsrGraph tree(std::vector<std::vector<int32_t> >{{1}, {2}, {}});
+ * dfs_on_tree(tree, 0);
+ */
+void dfs_on_tree(const CsrGraph& graph, int32_t current, int32_t parent=-1)
+{
+    for(int32_t i = graph.offsets[current]; i < graph.offsets[current+1]; i++)
+        if(graph.targets[i] != parent)
+            dfs_on_tree(graph, graph.targets[i], current);
+}
+
+
+/*
+ * Struct that holds result of iterative DFS.
+ *
+ * Variables
+ * ---------
+ * preorder - nodes in order of entering them
+ * postorder - nodes in order of leaving them
+ * tin - position of the node in 'preorder', -1 if node was not visited
+ * tout - last position in 'preorder' that belongs to subtree of the node, so
+ * subtree of 'v' is exactly preorder[tin[v]..tout[v]], -1 if node was not visited
+ * parent - parent of the node in DFS tree. Parent of root is root, -1 if node was not visited
+ */
+struct DfsOrder
+{
+    std::vector<int32_t> preorder;
+    std::vector<int32_t> postorder;
+    std::vector<int32_t> tin;
+    std::vector<int32_t> tout;
+    std::vector<int32_t> parent;
+
+    DfsOrder(int32_t number_of_nodes=0)
+        : tin(number_of_nodes, -1), tout(number_of_nodes, -1), parent(number_of_nodes, -1)
+    {
+        preorder.reserve(number_of_nodes);
+        postorder.reserve(number_of_nodes);
+    }
+
+    /* Check whether 'a' is an ancestor of 'b' (every node is its own ancestor). */
+    bool is_ancestor(int32_t a, int32_t b) const
+    {
+        return tin[a] <= tin[b] && tout[b] <= tout[a];
+    }
+};
+
+/*
+ * DFS algorithm with explicit stack for graphs stored in CSR format.
+ *
+ * Nodes are visited in exactly the same order as in recursive dfs(), but
+ * there is no recursion, so it works for graphs of any depth.
+ * Works for trees given with edges in both directions as well.
+ *
+ * Parameters
+ * ----------
+ * graph - graph representation using CSR format
+ * root - node to start from. If -1, all nodes are used as roots in increasing order
+ *
+ * Returns
+ * -------
+ * pre/post order, timestamps and parents of all nodes, see DfsOrder
+ *
+ * Examples
+ * --------
+ * std::vector<std::pair<int32_t, int32_t> > edges{{0, 1}, {0, 2}, {2, 3}};
+ * CsrGraph tree(4, edges, true);
+ * auto order = iterative_dfs(tree, 0);
+ * std::cout << order.is_ancestor(2, 3) << "\n";
+ */
+DfsOrder iterative_dfs(const CsrGraph& graph, int32_t root=-1)
+{
+    DfsOrder order(graph.number_of_nodes);
+    std::vector<std::pair<int32_t, int32_t> > stack;
+
+    int32_t first_root = (root == -1 ? 0 : root);
+    int32_t last_root = (root == -1 ? graph.number_of_nodes-1 : root);
+
+    for(int32_t start = first_root; start <= last_root; start++)
+    {
+        if(order.tin[start] != -1)
+            continue;
+
+        order.parent[start] = start;
+        order.tin[start] = order.preorder.size();
+        order.preorder.push_back(start);
+        stack.push_back({start, graph.offsets[start]});
+
+        while(!stack.empty())
+        {
+            auto& top = stack.back();
+            auto current = top.first;
+
+            if(top.second == graph.offsets[current+1])
+            {
+                order.tout[current] = order.preorder.size() - 1;
+                order.postorder.push_back(current);
+                stack.pop_back();
+                continue;
+            }
+
+            auto child = graph.targets[top.second++];
+            if(order.tin[child] != -1)
+                continue;
+
+            order.parent[child] = current;
+            order.tin[child] = order.preorder.size();
+            order.preorder.push_back(child);
+            stack.push_back({child, graph.offsets[child]});
+        }
+    }
+
+    return order;
+}
+
+/*
+ * DFS algorithm with explicit stack for graphs described in 'nodes' variable.
+ *
+ * Graph is converted to CSR format first, see iterative_dfs for CsrGraph.
+ *
+ * Examples
+ * --------
+ * std::vector<std::vector<int32_t> > graph{{1}, {2}, {0}};
+ * auto order = iterative_dfs(graph, 0);
+ */
+DfsOrder iterative_dfs(const std::vector<std::vector<int32_t> >& nodes, int32_t root=-1)
+{
+    return iterative_dfs(CsrGraph(nodes), root);
+}
@@ -1,9 +1,16 @@
 /* This file defines Dijkstra's algorithm. */
 
+#pragma once
+
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <vector>
 #include <queue>
+#include <thread>
+#include <utility>
+
+#include "csr_graph.cpp"
 
 const int32_t INF = 1000'000'005LL;
 
@@ -62,7 +69,7 @@ void dijkstra(std::vector<std::vector<Edge> >& graph, T& distance, int32_t graph
     distance[starting_point] = 0;
 
     std::priority_queue<Candidate, std::vector<Candidate>, Candidate> min_queue;
-    min_queue.push({0, 0});
+    min_queue.push({0, starting_point});
 
     while(!min_queue.empty())
     {
@@ -81,4 +88,786 @@ void dijkstra(std::vector<std::vector<Edge> >& graph, T& distance, int32_t graph
             }
         }
     }
-}
\ No newline at end of file
+}
+
+/*
+ * Priority queues that can be used by Dijkstra's algorithm.
+ *
+ * Every queue is constructed from maximal edge cost in the graph and provides
+ * push(distance, id), pop() returning Candidate with the smallest distance and
+ * empty(). Popped distances must never decrease (which holds for Dijkstra's
+ * algorithm with non-negative costs), so integer monotone queues can be used.
+ *
+ * BinaryHeapQueue - std::priority_queue, O(log n) per operation, works with any costs
+ * RadixHeapQueue - radix heap, amortized O(log C) per pop and O(1) per push
+ * BucketQueue - Dial's algorithm, circular array of C+1 buckets, O(1) per push
+ * and O(C) total scanning per distinct distance. Best for small 'max_edge_cost'
+ */
+struct BinaryHeapQueue
+{
+    std::priority_queue<Candidate, std::vector<Candidate>, Candidate> heap;
+
+    BinaryHeapQueue(int32_t=0)
+    {
+    }
+
+    void push(int32_t distance, int32_t id)
+    {
+        heap.push({distance, id});
+    }
+
+    Candidate pop()
+    {
+        auto top = heap.top();
+        heap.pop();
+        return top;
+    }
+
+    bool empty() const
+    {
+        return heap.empty();
+    }
+};
+
+struct RadixHeapQueue
+{
+    std::vector<Candidate> buckets[33];
+    uint32_t last;
+    int32_t size;
+
+    RadixHeapQueue(int32_t=0)
+        : last(0), size(0)
+    {
+    }
+
+    static int32_t bucket_of(uint32_t distance, uint32_t last)
+    {
+        return distance == last ? 0 : 32 - __builtin_clz(distance ^ last);
+    }
+
+    void push(int32_t distance, int32_t id)
+    {
+        buckets[bucket_of(distance, last)].push_back({distance, id});
+        size++;
+    }
+
+    Candidate pop()
+    {
+        if(buckets[0].empty())
+        {
+            int32_t i = 1;
+            while(buckets[i].empty())
+                i++;
+
+            last = buckets[i][0].distance;
+            for(auto& candidate: buckets[i])
+                last = std::min(last, (uint32_t)candidate.distance);
+            for(auto& candidate: buckets[i])
+                buckets[bucket_of(candidate.distance, last)].push_back(candidate);
+            buckets[i].clear();
+        }
+
+        auto top = buckets[0].back();
+        buckets[0].pop_back();
+        size--;
+        return top;
+    }
+
+    bool empty() const
+    {
+        return size == 0;
+    }
+};
+
+struct BucketQueue
+{
+    std::vector<std::vector<int32_t> > buckets;
+    int32_t current;
+    int32_t size;
+
+    BucketQueue(int32_t max_edge_cost=0)
+        : buckets(max_edge_cost+1), current(0), size(0)
+    {
+    }
+
+    void push(int32_t distance, int32_t id)
+    {
+        buckets[distance % buckets.size()].push_back(id);
+        size++;
+    }
+
+    Candidate pop()
+    {
+        while(buckets[current % buckets.size()].empty())
+            current++;
+
+        auto& bucket = buckets[current % buckets.size()];
+        auto id = bucket.back();
+        bucket.pop_back();
+        size--;
+        return {current, id};
+    }
+
+    bool empty() const
+    {
+        return size == 0;
+    }
+};
+
+/*
+ * Implementation of Dijkstra's algorithm for graphs stored in CSR format
+ *
+ * Parameters
+ * ----------
+ * graph - weighted graph representation using CSR format, costs must be non-negative
+ * distance - array which keeps distances in the graph. Can be both int[] and vector<int>
+ * starting_point - vertex to start from
+ * Queue - priority queue backend: BinaryHeapQueue, RadixHeapQueue or BucketQueue
+ *
+ * Usage
+ * -----
+ * CsrGraph graph(std::vector<std::vector<Edge> >{
+ *      {{1, 1}, {2, 4}},
+ *      {{2, 2}, {3, 3}},
+ *      {{3, 1}},
+ *      {}
+ * });
+ * std::vector<int32_t> distance(4);
+ * dijkstra(graph, distance, 0);
+ * dijkstra<RadixHeapQueue>(graph, distance, 0);
+ * dijkstra<BucketQueue>(graph, distance, 0);
+ */
+template<class Queue=BinaryHeapQueue, class T>
+void dijkstra(const CsrGraph& graph, T& distance, int32_t starting_point=0)
+{
+    for(int32_t i = 0; i < graph.number_of_nodes; i++)
+        distance[i] = INF;
+    distance[starting_point] = 0;
+
+    int32_t max_edge_cost = 0;
+    for(auto cost: graph.weights)
+        max_edge_cost = std::max(max_edge_cost, cost);
+
+    Queue min_queue(max_edge_cost);
+    min_queue.push(0, starting_point);
+
+    while(!min_queue.empty())
+    {
+        auto candidate = min_queue.pop();
+
+        if(candidate.distance != distance[candidate.id])
+            continue;
+
+        for(int32_t i = graph.offsets[candidate.id]; i < graph.offsets[candidate.id+1]; i++)
+        {
+            auto to = graph.targets[i];
+            if(candidate.distance + graph.weights[i] < distance[to])
+            {
+                distance[to] = candidate.distance + graph.weights[i];
+                min_queue.push(distance[to], to);
+            }
+        }
+    }
+}
+
+
+/*
+ * Indexed d-ary min-heap with decrease-key.
+ *
+ * Holds at most one entry per id in range [0, capacity), position of every id
+ * in the heap is tracked, so key of an id already in the heap can be decreased
+ * in place instead of pushing a duplicate. With D=4 siblings share a cache line
+ * and the tree is half as deep as binary heap.
+ *
+ * Examples
+ * --------
+ * IndexedDaryHeap<int32_t> heap(3);
+ * heap.push_or_decrease(0, 10);
+ * heap.push_or_decrease(1, 5);
+ * heap.push_or_decrease(0, 2);
+ * std::cout << heap.pop().first << "\n";
+ */
+template<class K=int32_t, int32_t D=4>
+struct IndexedDaryHeap
+{
+    std::vector<int32_t> heap;
+    std::vector<int32_t> position;
+    std::vector<K> key;
+
+    IndexedDaryHeap(int32_t capacity=0)
+        : position(capacity, -1), key(capacity)
+    {
+        heap.reserve(capacity);
+    }
+
+    bool empty() const
+    {
+        return heap.empty();
+    }
+
+    int32_t size() const
+    {
+        return heap.size();
+    }
+
+    bool contains(int32_t id) const
+    {
+        return position[id] != -1;
+    }
+
+    /* Remove all entries in O(size), without touching ids that are not in the heap. */
+    void clear()
+    {
+        for(auto id: heap)
+            position[id] = -1;
+        heap.clear();
+    }
+
+    /* Insert 'id' with 'new_key', or decrease its key if it is already in the heap.
+     * Does nothing if 'id' already has smaller or equal key.
+     */
+    void push_or_decrease(int32_t id, K new_key)
+    {
+        if(position[id] == -1)
+        {
+            position[id] = heap.size();
+            heap.push_back(id);
+        }
+        else if(!(new_key < key[id]))
+            return;
+
+        key[id] = new_key;
+        sift_up(position[id]);
+    }
+
+    /* Remove id with the smallest key.
+     *
+     * Returns
+     * -------
+     * pair of removed id and its key
+     */
+    std::pair<int32_t, K> pop()
+    {
+        auto top = heap[0];
+        position[top] = -1;
+
+        auto last = heap.back();
+        heap.pop_back();
+        if(!heap.empty())
+        {
+            heap[0] = last;
+            position[last] = 0;
+            sift_down(0);
+        }
+
+        return {top, key[top]};
+    }
+
+    void sift_up(int32_t index)
+    {
+        auto id = heap[index];
+        while(index > 0)
+        {
+            auto parent = (index - 1) / D;
+            if(!(key[id] < key[heap[parent]]))
+                break;
+
+            heap[index] = heap[parent];
+            position[heap[index]] = index;
+            index = parent;
+        }
+
+        heap[index] = id;
+        position[id] = index;
+    }
+
+    void sift_down(int32_t index)
+    {
+        auto id = heap[index];
+        int32_t heap_size = heap.size();
+        while(true)
+        {
+            auto first_child = D * index + 1;
+            if(first_child >= heap_size)
+                break;
+
+            auto best = first_child;
+            auto last_child = std::min(first_child + D, heap_size);
+            for(auto child = first_child + 1; child < last_child; child++)
+                if(key[heap[child]] < key[heap[best]])
+                    best = child;
+
+            if(!(key[heap[best]] < key[id]))
+                break;
+
+            heap[index] = heap[best];
+            position[heap[index]] = index;
+            index = best;
+        }
+
+        heap[index] = id;
+        position[id] = index;
+    }
+};
+
+/*
+ * Implementation of Dijkstra's algorithm with indexed 4-ary heap and decrease-key
+ *
+ * Queue never holds more than one entry per node, so its size is bounded by
+ * number of nodes instead of number of edges, and no stale entries are popped.
+ *
+ * Parameters
+ * ----------
+ * graph - weighted graph representation using CSR format, costs must be non-negative
+ * distance - array which keeps distances in the graph. Can be both int[] and vector<int>
+ * parent - array which keeps previous node on the shortest path, -1 for starting
+ * point and unreachable nodes. Can be both int[] and vector<int>
+ * starting_point - vertex to start from
+ *
+ * Usage
+ * -----
+ * std::vector<int32_t> distance(4), parent(4);
+ * dijkstra_decrease_key(graph, distance, parent, 0);
+ * auto path = restore_path(parent, 3);
+ */
+template<class T, class P>
+void dijkstra_decrease_key(const CsrGraph& graph, T& distance, P& parent, int32_t starting_point=0)
+{
+    for(int32_t i = 0; i < graph.number_of_nodes; i++)
+    {
+        distance[i] = INF;
+        parent[i] = -1;
+    }
+    distance[starting_point] = 0;
+
+    IndexedDaryHeap<int32_t, 4> min_queue(graph.number_of_nodes);
+    min_queue.push_or_decrease(starting_point, 0);
+
+    while(!min_queue.empty())
+    {
+        auto current = min_queue.pop().first;
+
+        for(int32_t i = graph.offsets[current]; i < graph.offsets[current+1]; i++)
+        {
+            auto to = graph.targets[i];
+            if(distance[current] + graph.weights[i] < distance[to])
+            {
+                distance[to] = distance[current] + graph.weights[i];
+                parent[to] = current;
+                min_queue.push_or_decrease(to, distance[to]);
+            }
+        }
+    }
+}
+
+/*
+ * Restore path from array of parents.
+ *
+ * Parameters
+ * ----------
+ * parent - array of parents, -1 for the starting point. Can be both int[] and vector<int>
+ * target - last node of the path
+ *
+ * Returns
+ * -------
+ * nodes on the path from the starting point to 'target'
+ */
+template<class P>
+std::vector<int32_t> restore_path(P& parent, int32_t target)
+{
+    std::vector<int32_t> path;
+    for(auto current = target; current != -1; current = parent[current])
+        path.push_back(current);
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+
+/*
+ * Reusable scratch buffers for repeated Dijkstra's queries on the same graph.
+ *
+ * Every node remembers generation (query number) in which its distance was
+ * last written, so starting a new query is O(1) instead of O(number of nodes).
+ * Only nodes touched by the query are ever read or written.
+ *
+ * Examples
+ * --------
+ * DijkstraWorkspace workspace(graph.number_of_nodes);
+ * workspace.run(graph, {0}, {3});
+ * std::cout << workspace.distance(3) << "\n";
+ */
+struct DijkstraWorkspace
+{
+    std::vector<int32_t> distances;
+    std::vector<int32_t> parents;
+    std::vector<uint32_t> generation_of;
+    std::vector<uint32_t> target_generation_of;
+    uint32_t generation;
+    IndexedDaryHeap<int32_t, 4> min_queue;
+
+    DijkstraWorkspace(int32_t number_of_nodes=0)
+        : distances(number_of_nodes), parents(number_of_nodes),
+        generation_of(number_of_nodes, 0), target_generation_of(number_of_nodes, 0),
+        generation(0), min_queue(number_of_nodes)
+    {
+    }
+
+    /* Distance from the closest source in the last query, INF if node was not reached. */
+    int32_t distance(int32_t node) const
+    {
+        return generation_of[node] == generation ? distances[node] : INF;
+    }
+
+    /* Previous node on the shortest path in the last query, -1 for sources and unreached nodes. */
+    int32_t parent(int32_t node) const
+    {
+        return generation_of[node] == generation ? parents[node] : -1;
+    }
+
+    /* Run Dijkstra's algorithm from all 'sources' at once.
+     *
+     * Parameters
+     * ----------
+     * graph - weighted graph representation using CSR format, costs must be non-negative
+     * sources - nodes with distance 0
+     * targets - if not empty, search stops as soon as all of them are settled.
+     * Distances of other nodes are then only upper bounds
+     */
+    void run(const CsrGraph& graph, const std::vector<int32_t>& sources,
+        const std::vector<int32_t>& targets={})
+    {
+        start(sources);
+
+        int32_t remaining_targets = 0;
+        for(auto target: targets)
+            if(target_generation_of[target] != generation)
+            {
+                target_generation_of[target] = generation;
+                remaining_targets++;
+            }
+
+        while(!min_queue.empty())
+        {
+            auto current = settle_next(graph);
+
+            if(target_generation_of[current] == generation)
+            {
+                target_generation_of[current] = 0;
+                if(--remaining_targets == 0)
+                    break;
+            }
+        }
+
+        finish();
+    }
+
+    /* Start new query from 'sources'. Search is then advanced with settle_next. */
+    void start(const std::vector<int32_t>& sources)
+    {
+        if(++generation == 0)
+        {
+            std::fill(generation_of.begin(), generation_of.end(), 0);
+            std::fill(target_generation_of.begin(), target_generation_of.end(), 0);
+            generation = 1;
+        }
+
+        for(auto source: sources)
+        {
+            generation_of[source] = generation;
+            distances[source] = 0;
+            parents[source] = -1;
+            min_queue.push_or_decrease(source, 0);
+        }
+    }
+
+    /* Smallest key in the queue, INF if the queue is empty. */
+    int32_t top_key() const
+    {
+        return min_queue.empty() ? INF : min_queue.key[min_queue.heap[0]];
+    }
+
+    /* Pop node with the smallest key and relax its outgoing edges.
+     *
+     * Parameters
+     * ----------
+     * graph - weighted graph representation using CSR format
+     * potential - function returning lower bound on distance from node to the
+     * target (A* heuristic). Queue is ordered by distance + potential
+     *
+     * Returns
+     * -------
+     * popped node
+     */
+    template<class H>
+    int32_t settle_next(const CsrGraph& graph, H potential)
+    {
+        auto current = min_queue.pop().first;
+
+        for(int32_t i = graph.offsets[current]; i < graph.offsets[current+1]; i++)
+        {
+            auto to = graph.targets[i];
+            auto candidate = distances[current] + graph.weights[i];
+            if(candidate < distance(to))
+            {
+                generation_of[to] = generation;
+                distances[to] = candidate;
+                parents[to] = current;
+                min_queue.push_or_decrease(to, candidate + potential(to));
+            }
+        }
+
+        return current;
+    }
+
+    int32_t settle_next(const CsrGraph& graph)
+    {
+        return settle_next(graph, [](int32_t) { return 0; });
+    }
+
+    /* Empty the queue after the search has stopped early. */
+    void finish()
+    {
+        min_queue.clear();
+    }
+
+    /* Nodes on the shortest path from the closest source to 'target' in the last query. */
+    std::vector<int32_t> path_to(int32_t target) const
+    {
+        std::vector<int32_t> path;
+        if(distance(target) == INF)
+            return path;
+
+        for(auto current = target; current != -1; current = parent(current))
+            path.push_back(current);
+
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+};
+
+/* Struct that holds single query for DijkstraEngine. */
+struct DijkstraQuery
+{
+    std::vector<int32_t> sources;
+    std::vector<int32_t> targets;
+};
+
+/*
+ * Engine for answering many Dijkstra's queries on the same graph.
+ *
+ * Keeps the graph and scratch buffers (see DijkstraWorkspace) between
+ * queries, supports multiple sources and early termination once a target set
+ * is settled, and can answer batches of independent queries on many threads,
+ * each thread with its own workspace.
+ *
+ * Examples
+ * --------
+ * DijkstraEngine engine(graph);
+ * engine.run({0}, {3});
+ * std::cout << engine.distance(3) << "\n";
+ *
+ * std::vector<DijkstraQuery> queries{{{0}, {2, 3}}, {{1, 2}, {3}}};
+ * auto answers = engine.run_batch(queries, 4);
+ * std::cout << answers[0][1] << "\n";
+ */
+struct DijkstraEngine
+{
+    const CsrGraph& graph;
+    DijkstraWorkspace workspace;
+    std::vector<DijkstraWorkspace> thread_workspaces;
+
+    DijkstraEngine(const CsrGraph& graph)
+        : graph(graph), workspace(graph.number_of_nodes)
+    {
+    }
+
+    void run(const std::vector<int32_t>& sources, const std::vector<int32_t>& targets={})
+    {
+        workspace.run(graph, sources, targets);
+    }
+
+    int32_t distance(int32_t node) const
+    {
+        return workspace.distance(node);
+    }
+
+    int32_t parent(int32_t node) const
+    {
+        return workspace.parent(node);
+    }
+
+    /* Answer independent queries in parallel.
+     *
+     * Parameters
+     * ----------
+     * queries - queries to answer, every one of them must have non-empty 'targets'
+     * number_of_threads - number of threads to use
+     *
+     * Returns
+     * -------
+     * for every query, distances to its targets in the order of 'targets'
+     */
+    std::vector<std::vector<int32_t> > run_batch(const std::vector<DijkstraQuery>& queries,
+        int32_t number_of_threads=std::thread::hardware_concurrency())
+    {
+        number_of_threads = std::max(1, std::min<int32_t>(number_of_threads, queries.size()));
+        while((int32_t)thread_workspaces.size() < number_of_threads)
+            thread_workspaces.emplace_back(graph.number_of_nodes);
+
+        std::vector<std::vector<int32_t> > answers(queries.size());
+        std::atomic<int32_t> next_query(0);
+
+        auto worker = [&](DijkstraWorkspace& local)
+        {
+            for(int32_t i = next_query++; i < (int32_t)queries.size(); i = next_query++)
+            {
+                local.run(graph, queries[i].sources, queries[i].targets);
+                for(auto target: queries[i].targets)
+                    answers[i].push_back(local.distance(target));
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for(int32_t i = 1; i < number_of_threads; i++)
+            threads.emplace_back(worker, std::ref(thread_workspaces[i]));
+        worker(thread_workspaces[0]);
+        for(auto& thread: threads)
+            thread.join();
+
+        return answers;
+    }
+};
+
+
+/*
+ * Bidirectional Dijkstra's algorithm for point-to-point queries.
+ *
+ * Searches from the source on 'graph' and from the target on 'reversed' graph,
+ * always advancing the side with the smaller queue key, and stops once sum of
+ * both smallest keys reaches the best path found so far. Typically settles
+ * nodes only within a ball of half of the distance around both ends. Scratch
+ * buffers are reused between queries.
+ *
+ * Examples
+ * --------
+ * CsrGraph reversed = graph.transposed();
+ * BidirectionalDijkstra search(graph, reversed);
+ * std::cout << search.query(0, 3) << "\n";
+ * auto path = search.path();
+ */
+struct BidirectionalDijkstra
+{
+    const CsrGraph& graph;
+    const CsrGraph& reversed;
+    DijkstraWorkspace forward;
+    DijkstraWorkspace backward;
+    int32_t best;
+    int32_t meeting_from;
+    int32_t meeting_to;
+
+    BidirectionalDijkstra(const CsrGraph& graph, const CsrGraph& reversed)
+        : graph(graph), reversed(reversed), forward(graph.number_of_nodes),
+        backward(graph.number_of_nodes), best(INF), meeting_from(-1), meeting_to(-1)
+    {
+    }
+
+    /* Length of the shortest path from 'source' to 'target', INF if there is no path. */
+    int32_t query(int32_t source, int32_t target)
+    {
+        best = INF;
+        meeting_from = meeting_to = -1;
+        forward.start({source});
+        backward.start({target});
+
+        if(source == target)
+        {
+            best = 0;
+            meeting_from = meeting_to = source;
+        }
+
+        while(forward.top_key() < INF && backward.top_key() < INF
+            && (int64_t)forward.top_key() + backward.top_key() < best)
+        {
+            bool is_forward = forward.top_key() <= backward.top_key();
+            auto& side = (is_forward ? forward : backward);
+            auto& other = (is_forward ? backward : forward);
+            auto& side_graph = (is_forward ? graph : reversed);
+
+            auto current = side.settle_next(side_graph);
+            for(int32_t i = side_graph.offsets[current]; i < side_graph.offsets[current+1]; i++)
+            {
+                auto to = side_graph.targets[i];
+                if(other.distance(to) == INF)
+                    continue;
+
+                auto length = side.distance(current) + side_graph.weights[i] + other.distance(to);
+                if(length < best)
+                {
+                    best = length;
+                    meeting_from = (is_forward ? current : to);
+                    meeting_to = (is_forward ? to : current);
+                }
+            }
+        }
+
+        forward.finish();
+        backward.finish();
+        return best;
+    }
+
+    /* Nodes on the shortest path found by the last query, empty if there was no path. */
+    std::vector<int32_t> path() const
+    {
+        if(meeting_from == -1)
+            return {};
+
+        auto result = forward.path_to(meeting_from);
+        for(auto current = meeting_to; current != -1; current = backward.parent(current))
+            if(current != result.back())
+                result.push_back(current);
+
+        return result;
+    }
+};
+
+/*
+ * A* search for point-to-point queries.
+ *
+ * Dijkstra's algorithm with queue ordered by distance + heuristic(node), which
+ * steers the search towards the target. Result is exact if the heuristic is
+ * admissible (never overestimates the remaining distance); with consistent
+ * heuristic every node is settled at most once. Heuristic equal to 0 gives
+ * plain Dijkstra's algorithm stopped at the target.
+ *
+ * Parameters
+ * ----------
+ * graph - weighted graph representation using CSR format, costs must be non-negative
+ * workspace - reusable buffers, afterwards workspace.path_to(target) gives the path
+ * source - vertex to start from
+ * target - vertex to find distance to
+ * heuristic - function returning lower bound on distance from node to 'target'
+ *
+ * Returns
+ * -------
+ * length of the shortest path from 'source' to 'target', INF if there is no path
+ *
+ * Usage
+ * -----
+ * DijkstraWorkspace workspace(graph.number_of_nodes);
+ * auto straight_line = [&](int32_t node) { return lower_bound_to_target[node]; };
+ * std::cout << a_star(graph, workspace, 0, 3, straight_line) << "\n";
+ */
+template<class H>
+int32_t a_star(const CsrGraph& graph, DijkstraWorkspace& workspace, int32_t source,
+    int32_t target, H heuristic)
+{
+    workspace.start({source});
+
+    while(!workspace.min_queue.empty())
+        if(workspace.settle_next(graph, heuristic) == target)
+            break;
+
+    workspace.finish();
+    return workspace.distance(target);
+}
@@ -0,0 +1,154 @@
+/* This file implements offline dynamic connectivity. */
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "find_and_union.cpp"
+
+/*
+ * Offline dynamic connectivity.
+ *
+ * Operations (edge insertions, edge deletions and connectivity queries) are
+ * recorded first and answered together by solve(). Every edge is alive during
+ * an interval of operation indices, which is split into O(log q) nodes of a
+ * segment tree over time. DFS over this tree unites edges of the node on
+ * entry and rolls them back on exit with RollbackDisjointSetUnion, so at a
+ * leaf the structure holds exactly the edges alive at that moment.
+ * Total time is O((n + q) log q log n).
+ *
+ * Multiple copies of the same edge are allowed, remove_edge deletes one of them.
+ * Removing an edge that is not present is ignored.
+ *
+ * Examples
+ * --------
+ * DynamicConnectivity connectivity(3);
+ * connectivity.add_edge(0, 1);
+ * connectivity.query(0, 1);
+ * connectivity.remove_edge(1, 0);
+ * connectivity.query(0, 1);
+ * auto answers = connectivity.solve(); // {true, false}
+ */
+struct DynamicConnectivity
+{
+    struct Operation
+    {
+        int32_t type;
+        int32_t a;
+        int32_t b;
+    };
+
+    static const int32_t ADD = 0;
+    static const int32_t REMOVE = 1;
+    static const int32_t QUERY = 2;
+
+    int32_t number_of_nodes;
+    std::vector<Operation> operations;
+    std::vector<std::vector<std::pair<int32_t, int32_t> > > edges_of_node;
+    std::vector<bool> answers;
+
+    DynamicConnectivity(int32_t number_of_nodes)
+        : number_of_nodes(number_of_nodes)
+    {
+    }
+
+    void add_edge(int32_t a, int32_t b)
+    {
+        operations.push_back({ADD, a, b});
+    }
+
+    void remove_edge(int32_t a, int32_t b)
+    {
+        operations.push_back({REMOVE, a, b});
+    }
+
+    /* Ask whether 'a' and 'b' are connected at this moment. */
+    void query(int32_t a, int32_t b)
+    {
+        operations.push_back({QUERY, a, b});
+    }
+
+    /* Add 'edge' to every node of the tree fully covered by range [lf, rt]. */
+    void insert(int32_t lf, int32_t rt, std::pair<int32_t, int32_t> edge,
+        int32_t node, int32_t node_lf, int32_t node_rt)
+    {
+        if(rt < node_lf || node_rt < lf)
+            return;
+
+        if(lf <= node_lf && node_rt <= rt)
+        {
+            edges_of_node[node].push_back(edge);
+            return;
+        }
+
+        int32_t middle = (node_lf + node_rt) / 2;
+        insert(lf, rt, edge, 2*node, node_lf, middle);
+        insert(lf, rt, edge, 2*node+1, middle+1, node_rt);
+    }
+
+    void traverse(RollbackDisjointSetUnion& dsu, int32_t node, int32_t node_lf, int32_t node_rt)
+    {
+        auto snapshot = dsu.snapshot();
+        for(auto& edge: edges_of_node[node])
+            dsu.unite(edge.first, edge.second);
+
+        if(node_lf == node_rt)
+        {
+            auto& operation = operations[node_lf];
+            if(operation.type == QUERY)
+                answers.push_back(dsu.same(operation.a, operation.b));
+        }
+        else
+        {
+            int32_t middle = (node_lf + node_rt) / 2;
+            traverse(dsu, 2*node, node_lf, middle);
+            traverse(dsu, 2*node+1, middle+1, node_rt);
+        }
+
+        dsu.rollback(snapshot);
+    }
+
+    /* Answer all recorded queries.
+     *
+     * Returns
+     * -------
+     * answers to the queries, in order in which they were asked
+     */
+    std::vector<bool> solve()
+    {
+        answers.clear();
+        int32_t number_of_operations = operations.size();
+        if(number_of_operations == 0)
+            return answers;
+
+        edges_of_node.assign(4 * number_of_operations, {});
+        std::map<std::pair<int32_t, int32_t>, std::vector<int32_t> > alive_since;
+        for(int32_t time = 0; time < number_of_operations; time++)
+        {
+            auto& operation = operations[time];
+            auto edge = std::make_pair(std::min(operation.a, operation.b), std::max(operation.a, operation.b));
+            if(operation.type == ADD)
+                alive_since[edge].push_back(time);
+            else if(operation.type == REMOVE)
+            {
+                auto it = alive_since.find(edge);
+                if(it == alive_since.end() || it->second.empty())
+                    continue;
+
+                insert(it->second.back(), time, edge, 1, 0, number_of_operations-1);
+                it->second.pop_back();
+            }
+        }
+
+        for(auto& alive: alive_since)
+            for(auto time: alive.second)
+                insert(time, number_of_operations-1, alive.first, 1, 0, number_of_operations-1);
+
+        RollbackDisjointSetUnion dsu(number_of_nodes);
+        traverse(dsu, 1, 0, number_of_operations-1);
+        edges_of_node.clear();
+        return answers;
+    }
+};
@@ -0,0 +1,224 @@
+/* This file implements different kinds of Fenwick tree. */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Fenwick tree (binary indexed tree) implementation
+ *
+ * Adds value to a single position, and queries sum over the range. Uses n+1
+ * values of T, half of what RangePointSegmentTree needs. For range add and
+ * point query add 'value' at 'lf' and '-value' at 'rt+1', then value at
+ * 'position' is prefix(position+1).
+ *
+ * Warning
+ * -------
+ * add, query and lower_bound functions are 0-indexed.
+ *
+ * Examples
+ * --------
+ * FenwickTree<int64_t> tree(100);
+ * tree.add(0, 10);
+ * tree.add(1, 5);
+ * std::cout << tree.query(0, 99) << '\n';
+ * std::cout << tree.lower_bound(11) << '\n';
+ */
+template<class T=int64_t>
+struct FenwickTree
+{
+    std::vector<T> nodes;
+    int32_t number_of_nodes;
+    int32_t highest_power;
+
+    FenwickTree(int32_t number_of_nodes=0)
+    {
+        resize(number_of_nodes);
+    }
+
+    void resize(int32_t new_number_of_nodes)
+    {
+        number_of_nodes = new_number_of_nodes;
+        nodes.assign(number_of_nodes+1, T());
+        highest_power = 1;
+        while(2*highest_power <= number_of_nodes)
+            highest_power *= 2;
+    }
+
+    /* Build nodes from predefined values in O(n).
+     *
+     * Parameters
+     * ----------
+     * array - array to build from. Can both vector<int> and int[].
+     * array_size - size of 'array'
+     */
+    template<class A>
+    void build_from_array(A& array, int32_t array_size)
+    {
+        resize(array_size);
+        for(int32_t i = 1; i <= number_of_nodes; i++)
+        {
+            nodes[i] += array[i-1];
+            int32_t parent = i + (i & -i);
+            if(parent <= number_of_nodes)
+                nodes[parent] += nodes[i];
+        }
+    }
+
+    void add(int32_t position, T value)
+    {
+        for(position++; position <= number_of_nodes; position += position & -position)
+            nodes[position] += value;
+    }
+
+    /* Sum over [0, position). */
+    T prefix(int32_t position) const
+    {
+        T result = T();
+        for(; position > 0; position -= position & -position)
+            result += nodes[position];
+
+        return result;
+    }
+
+    T query(int32_t lf, int32_t rt) const
+    {
+        return prefix(rt+1) - prefix(lf);
+    }
+
+    /* Smallest position such that sum over [0, position] is at least 'sum',
+     * or number_of_nodes if there is none. All values must be non-negative.
+     */
+    int32_t lower_bound(T sum) const
+    {
+        int32_t position = 0;
+        for(int32_t step = highest_power; step > 0; step >>= 1)
+        {
+            if(position + step <= number_of_nodes && nodes[position + step] < sum)
+            {
+                position += step;
+                sum -= nodes[position];
+            }
+        }
+
+        return position;
+    }
+};
+
+/*
+ * Range-Range Fenwick tree implementation
+ *
+ * Adds value to a range, and queries sum over a range. Keeps two Fenwick
+ * trees: 'linear' with added values and 'constant' with corrections, so that
+ * prefix sum of [0, position) is linear.prefix(position) * position + constant.prefix(position).
+ *
+ * Warning
+ * -------
+ * add and query functions are 0-indexed.
+ *
+ * Examples
+ * --------
+ * RangeFenwickTree<int64_t> tree(5);
+ * tree.add(0, 4, 100);
+ * tree.add(1, 1, 20);
+ * std::cout << tree.query(1, 2) << '\n';
+ */
+template<class T=int64_t>
+struct RangeFenwickTree
+{
+    FenwickTree<T> linear;
+    FenwickTree<T> constant;
+
+    RangeFenwickTree(int32_t number_of_nodes=0)
+        : linear(number_of_nodes), constant(number_of_nodes)
+    {
+    }
+
+    /* Build nodes from predefined values in O(n). */
+    template<class A>
+    void build_from_array(A& array, int32_t array_size)
+    {
+        linear.resize(array_size);
+        constant.build_from_array(array, array_size);
+    }
+
+    void add(int32_t lf, int32_t rt, T value)
+    {
+        linear.add(lf, value);
+        constant.add(lf, -value * lf);
+        if(rt+1 < linear.number_of_nodes)
+        {
+            linear.add(rt+1, -value);
+            constant.add(rt+1, value * (rt+1));
+        }
+    }
+
+    /* Sum over [0, position). */
+    T prefix(int32_t position) const
+    {
+        return linear.prefix(position) * position + constant.prefix(position);
+    }
+
+    T query(int32_t lf, int32_t rt) const
+    {
+        return prefix(rt+1) - prefix(lf);
+    }
+};
+
+/*
+ * Two-dimensional Fenwick tree implementation
+ *
+ * Adds value to a single cell, and queries sum over a rectangle in
+ * O(log n * log m). Nodes are kept in one contiguous array, row by row.
+ *
+ * Warning
+ * -------
+ * add and query functions are 0-indexed.
+ *
+ * Examples
+ * --------
+ * FenwickTree2D<int64_t> tree(3, 4);
+ * tree.add(1, 2, 5);
+ * tree.add(2, 3, 7);
+ * std::cout << tree.query(0, 0, 2, 3) << '\n';
+ * std::cout << tree.query(2, 0, 2, 3) << '\n';
+ */
+template<class T=int64_t>
+struct FenwickTree2D
+{
+    std::vector<T> nodes;
+    int32_t number_of_rows;
+    int32_t number_of_columns;
+
+    FenwickTree2D(int32_t number_of_rows=0, int32_t number_of_columns=0)
+        : nodes((int64_t)(number_of_rows+1) * (number_of_columns+1)),
+        number_of_rows(number_of_rows), number_of_columns(number_of_columns)
+    {
+    }
+
+    void add(int32_t row, int32_t column, T value)
+    {
+        for(int32_t i = row+1; i <= number_of_rows; i += i & -i)
+            for(int32_t j = column+1; j <= number_of_columns; j += j & -j)
+                nodes[(int64_t)i * (number_of_columns+1) + j] += value;
+    }
+
+    /* Sum over [0, row) x [0, column). */
+    T prefix(int32_t row, int32_t column) const
+    {
+        T result = T();
+        for(int32_t i = row; i > 0; i -= i & -i)
+            for(int32_t j = column; j > 0; j -= j & -j)
+                result += nodes[(int64_t)i * (number_of_columns+1) + j];
+
+        return result;
+    }
+
+    /* Sum over rectangle with corners (row_lf, column_lf) and (row_rt, column_rt), inclusive. */
+    T query(int32_t row_lf, int32_t column_lf, int32_t row_rt, int32_t column_rt) const
+    {
+        return prefix(row_rt+1, column_rt+1) - prefix(row_lf, column_rt+1)
+            - prefix(row_rt+1, column_lf) + prefix(row_lf, column_lf);
+    }
+};
@@ -1,6 +1,12 @@
 /* This file defines FIND & UNION algorithm. */
 
+#pragma once
+
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <thread>
+#include <utility>
 #include <vector>
 
 /*
@@ -61,4 +67,344 @@ void UNION(int32_t id_a, int32_t id_b, T& leader, D& group_size)
 
     leader[id_b] = id_a;
     group_size[id_a] += group_size[id_b];
-}
\ No newline at end of file
+}
+
+/*
+ * Disjoint set union with union by size and iterative path halving.
+ *
+ * Whole structure is a single array: non-negative entry is the parent of the
+ * element, negative entry marks a root and stores minus size of its set. FIND
+ * never recurses, so long chains cannot overflow the stack, and every step of
+ * path halving links the element to its grandparent. Amortized cost of an
+ * operation is O(alpha(n)).
+ *
+ * Variables
+ * ---------
+ * parent_or_size - parent of the element, or -size of the set for roots
+ * number_of_sets - number of disjoint sets
+ *
+ * Examples
+ * --------
+ * DisjointSetUnion dsu(3);
+ * dsu.unite(0, 1);
+ * std::cout << dsu.same(0, 1) << " " << dsu.size(2) << "\n";
+ * auto id = dsu.add();
+ */
+struct DisjointSetUnion
+{
+    std::vector<int32_t> parent_or_size;
+    int32_t number_of_sets;
+
+    DisjointSetUnion(int32_t number_of_elements=0)
+        : parent_or_size(number_of_elements, -1), number_of_sets(number_of_elements)
+    {
+    }
+
+    /* Preallocate memory for 'capacity' elements. */
+    void reserve(int32_t capacity)
+    {
+        parent_or_size.reserve(capacity);
+    }
+
+    /* Add new singleton set. Returns id of the new element. */
+    int32_t add()
+    {
+        parent_or_size.push_back(-1);
+        number_of_sets++;
+        return parent_or_size.size() - 1;
+    }
+
+    int32_t find(int32_t id)
+    {
+        while(parent_or_size[id] >= 0)
+        {
+            auto parent = parent_or_size[id];
+            if(parent_or_size[parent] < 0)
+                return parent;
+            parent_or_size[id] = parent_or_size[parent];
+            id = parent_or_size[id];
+        }
+
+        return id;
+    }
+
+    /* Merge sets of 'id_a' and 'id_b'. Returns false if they were already in one set. */
+    bool unite(int32_t id_a, int32_t id_b)
+    {
+        id_a = find(id_a);
+        id_b = find(id_b);
+        if(id_a == id_b)
+            return false;
+
+        if(parent_or_size[id_a] > parent_or_size[id_b])
+            std::swap(id_a, id_b);
+
+        parent_or_size[id_a] += parent_or_size[id_b];
+        parent_or_size[id_b] = id_a;
+        number_of_sets--;
+        return true;
+    }
+
+    bool same(int32_t id_a, int32_t id_b)
+    {
+        return find(id_a) == find(id_b);
+    }
+
+    /* Size of the set containing 'id'. */
+    int32_t size(int32_t id)
+    {
+        return -parent_or_size[find(id)];
+    }
+};
+
+/*
+ * Lock-free disjoint set union that many threads can use at once.
+ *
+ * Parent links are atomic and change only through compare-and-swap. Roots are
+ * linked by randomized priority (hash of the id, ties broken by id): the root
+ * with lower priority always becomes the child, so links never form a cycle
+ * and trees stay O(log n) deep in expectation without storing sizes. FIND
+ * uses path splitting, every element on the path is CASed to its grandparent;
+ * a failed CAS only means another thread already shortened the path.
+ *
+ * Variables
+ * ---------
+ * parent - parent of the element, roots are their own parents
+ *
+ * Examples
+ * --------
+ * ConcurrentDisjointSetUnion dsu(4);
+ * std::thread worker([&]() { dsu.unite(0, 1); });
+ * dsu.unite(2, 3);
+ * worker.join();
+ * std::cout << dsu.same(0, 1) << " " << dsu.same(1, 2) << "\n";
+ */
+struct ConcurrentDisjointSetUnion
+{
+    std::vector<std::atomic<int32_t> > parent;
+
+    ConcurrentDisjointSetUnion(int32_t number_of_elements=0)
+        : parent(number_of_elements)
+    {
+        for(int32_t i = 0; i < number_of_elements; i++)
+            parent[i].store(i, std::memory_order_relaxed);
+    }
+
+    static uint32_t priority(int32_t id)
+    {
+        uint32_t hash = id;
+        hash ^= hash >> 16;
+        hash *= 0x7feb352d;
+        hash ^= hash >> 15;
+        hash *= 0x846ca68b;
+        hash ^= hash >> 16;
+        return hash;
+    }
+
+    static bool is_lower(int32_t id_a, int32_t id_b)
+    {
+        return std::make_pair(priority(id_a), id_a) < std::make_pair(priority(id_b), id_b);
+    }
+
+    int32_t find(int32_t id)
+    {
+        while(true)
+        {
+            auto next = parent[id].load();
+            if(next == id)
+                return id;
+
+            auto grandparent = parent[next].load();
+            if(next != grandparent)
+                parent[id].compare_exchange_weak(next, grandparent);
+            id = next;
+        }
+    }
+
+    /* Merge sets of 'id_a' and 'id_b'. Returns false if they were already in one set. */
+    bool unite(int32_t id_a, int32_t id_b)
+    {
+        while(true)
+        {
+            id_a = find(id_a);
+            id_b = find(id_b);
+            if(id_a == id_b)
+                return false;
+
+            if(is_lower(id_b, id_a))
+                std::swap(id_a, id_b);
+
+            auto expected = id_a;
+            if(parent[id_a].compare_exchange_strong(expected, id_b))
+                return true;
+        }
+    }
+
+    bool same(int32_t id_a, int32_t id_b)
+    {
+        while(true)
+        {
+            id_a = find(id_a);
+            id_b = find(id_b);
+            if(id_a == id_b)
+                return true;
+            if(parent[id_a].load() == id_a)
+                return false;
+        }
+    }
+};
+
+/*
+ * Multi-threaded connected components.
+ *
+ * Edges are split into contiguous chunks and every thread merges its chunk
+ * into shared ConcurrentDisjointSetUnion. Then components are labelled in
+ * parallel over contiguous ranges of nodes.
+ *
+ * Parameters
+ * ----------
+ * number_of_nodes - number of nodes in the graph
+ * edges - list of (from, to) pairs, direction is ignored
+ * number_of_threads - number of threads to use
+ *
+ * Returns
+ * -------
+ * array where i-th element is the representative of the i-th node's component.
+ * Two nodes are connected if and only if their representatives are equal
+ *
+ * Examples
+ * --------
+ * std::vector<std::pair<int32_t, int32_t> > edges{{0, 1}, {2, 3}};
+ * auto component = parallel_connected_components(4, edges, 4);
+ */
+std::vector<int32_t> parallel_connected_components(int32_t number_of_nodes,
+    const std::vector<std::pair<int32_t, int32_t> >& edges,
+    int32_t number_of_threads=std::thread::hardware_concurrency())
+{
+    number_of_threads = std::max(number_of_threads, 1);
+    ConcurrentDisjointSetUnion dsu(number_of_nodes);
+    std::vector<int32_t> component(number_of_nodes);
+
+    auto run = [&](int64_t count, auto function)
+    {
+        std::vector<std::thread> threads;
+        for(int32_t i = 1; i < number_of_threads; i++)
+            threads.emplace_back(function, count * i / number_of_threads,
+                count * (i+1) / number_of_threads);
+        function(0, count / number_of_threads);
+        for(auto& thread: threads)
+            thread.join();
+    };
+
+    run(edges.size(), [&](int64_t begin, int64_t end)
+    {
+        for(int64_t i = begin; i < end; i++)
+            dsu.unite(edges[i].first, edges[i].second);
+    });
+
+    run(number_of_nodes, [&](int64_t begin, int64_t end)
+    {
+        for(int64_t i = begin; i < end; i++)
+            component[i] = dsu.find(i);
+    });
+
+    return component;
+}
+
+/*
+ * Disjoint set union that can undo merges.
+ *
+ * Uses union by size without path compression, so every tree has depth
+ * O(log n) and FIND takes O(log n). Every call to unite pushes the root that
+ * was attached and its size onto undo stack, and rollback pops merges in
+ * reverse order, restoring the exact previous state.
+ *
+ * Variables
+ * ---------
+ * parent_or_size - parent of the element, or -size of the set for roots
+ * history - (attached root, its size) for every call to unite, in order,
+ * (-1, 0) for calls that merged nothing
+ * number_of_sets - number of disjoint sets
+ *
+ * Examples
+ * --------
+ * RollbackDisjointSetUnion dsu(3);
+ * auto snapshot = dsu.snapshot();
+ * dsu.unite(0, 1);
+ * dsu.rollback(snapshot);
+ * std::cout << dsu.same(0, 1) << "\n";
+ */
+struct RollbackDisjointSetUnion
+{
+    std::vector<int32_t> parent_or_size;
+    std::vector<std::pair<int32_t, int32_t> > history;
+    int32_t number_of_sets;
+
+    RollbackDisjointSetUnion(int32_t number_of_elements=0)
+        : parent_or_size(number_of_elements, -1), number_of_sets(number_of_elements)
+    {
+    }
+
+    int32_t find(int32_t id) const
+    {
+        while(parent_or_size[id] >= 0)
+            id = parent_or_size[id];
+
+        return id;
+    }
+
+    /* Merge sets of 'id_a' and 'id_b'. Returns false if they were already in one set. */
+    bool unite(int32_t id_a, int32_t id_b)
+    {
+        id_a = find(id_a);
+        id_b = find(id_b);
+        if(id_a == id_b)
+        {
+            history.push_back({-1, 0});
+            return false;
+        }
+
+        if(parent_or_size[id_a] > parent_or_size[id_b])
+            std::swap(id_a, id_b);
+
+        history.push_back({id_b, parent_or_size[id_b]});
+        parent_or_size[id_a] += parent_or_size[id_b];
+        parent_or_size[id_b] = id_a;
+        number_of_sets--;
+        return true;
+    }
+
+    /* Current state, to be passed to rollback. */
+    int32_t snapshot() const
+    {
+        return history.size();
+    }
+
+    /* Undo all calls to unite made after 'snapshot' was taken. */
+    void rollback(int32_t snapshot)
+    {
+        while((int32_t)history.size() > snapshot)
+        {
+            auto change = history.back();
+            history.pop_back();
+            if(change.first == -1)
+                continue;
+
+            auto root = parent_or_size[change.first];
+            parent_or_size[root] -= change.second;
+            parent_or_size[change.first] = change.second;
+            number_of_sets++;
+        }
+    }
+
+    bool same(int32_t id_a, int32_t id_b) const
+    {
+        return find(id_a) == find(id_b);
+    }
+
+    /* Size of the set containing 'id'. */
+    int32_t size(int32_t id) const
+    {
+        return -parent_or_size[find(id)];
+    }
+};
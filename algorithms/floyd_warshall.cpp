@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <vector>
 
 const int32_t INF = 1000'000'005;
 
@@ -27,4 +28,111 @@ void floyd_warshall(T& graph, int32_t dimension)
             for (int j = 0; j < dimension; ++j)
                 if (graph[i][k] < INF && graph[k][j] < INF)
                     graph[i][j] = std::min(graph[i][j], graph[i][k] + graph[k][j]); 
-}
\ No newline at end of file
+}
+
+/*
+ * Min-plus update of one block of the distance matrix.
+ *
+ * matrix[i][j] = min(matrix[i][j], matrix[i][k] + matrix[k][j]) for i, j, k
+ * in the given ranges. The innermost loop is branch-free and runs over
+ * contiguous memory, so it is vectorized by the compiler.
+ */
+template<class T>
+void floyd_warshall_block(T* matrix, int32_t dimension, int32_t i_begin, int32_t i_end,
+    int32_t j_begin, int32_t j_end, int32_t k_begin, int32_t k_end)
+{
+    for(int32_t k = k_begin; k < k_end; k++)
+    {
+        const T* row_k = matrix + (int64_t)k * dimension;
+        for(int32_t i = i_begin; i < i_end; i++)
+        {
+            T* row_i = matrix + (int64_t)i * dimension;
+            T via_k = row_i[k];
+            for(int32_t j = j_begin; j < j_end; j++)
+                row_i[j] = std::min(row_i[j], via_k + row_k[j]);
+        }
+    }
+}
+
+/*
+ * Min-plus update of a block that does not share rows nor columns with
+ * intermediate nodes [k_begin, k_end), so rows i and k never alias and the
+ * loop order can keep row i in registers/L1 for all k.
+ */
+template<class T>
+void floyd_warshall_independent_block(T* matrix, int32_t dimension, int32_t i_begin, int32_t i_end,
+    int32_t j_begin, int32_t j_end, int32_t k_begin, int32_t k_end)
+{
+    for(int32_t i = i_begin; i < i_end; i++)
+    {
+        T* __restrict row_i = matrix + (int64_t)i * dimension;
+        for(int32_t k = k_begin; k < k_end; k++)
+        {
+            const T* __restrict row_k = matrix + (int64_t)k * dimension;
+            T via_k = row_i[k];
+            for(int32_t j = j_begin; j < j_end; j++)
+                row_i[j] = std::min(row_i[j], via_k + row_k[j]);
+        }
+    }
+}
+
+/*
+ * Cache-blocked implementation of Floyd-Warshall algorithm
+ *
+ * Matrix is split into 'block_size' x 'block_size' tiles. For every block of
+ * intermediate nodes, first the diagonal tile, then tiles in its row and
+ * column, and finally all remaining tiles are updated, so each update works on
+ * at most three tiles that stay in cache. There is no INF check in the inner
+ * loop; instead INF + INF must fit in T (true for INF defined above and int32_t)
+ * and values that drifted below INF because of negative edges are clamped back
+ * to INF at the end, which requires every finite path to be shorter than INF/2.
+ * Inner loop is vectorized only with -O3 (or #pragma GCC optimize("O3")),
+ * preferably together with -march=native.
+ *
+ * Parameters
+ * ----------
+ * matrix - graph in contiguous row-major form, element [i][j] is matrix[i*dimension+j]
+ * dimension - number of nodes in the graph
+ * block_size - size of the tile side
+ *
+ * Usage
+ * -----
+ * std::vector<int32_t> x = {0, 1, INF, INF, 0, 1, 1, INF, 0};
+ * blocked_floyd_warshall(x, 3);
+ */
+template<class T>
+void blocked_floyd_warshall(std::vector<T>& matrix, int32_t dimension, int32_t block_size=64)
+{
+    T* data = matrix.data();
+    for(int32_t k = 0; k < dimension; k += block_size)
+    {
+        int32_t k_end = std::min(k + block_size, dimension);
+        floyd_warshall_block(data, dimension, k, k_end, k, k_end, k, k_end);
+
+        for(int32_t other = 0; other < dimension; other += block_size)
+        {
+            if(other == k)
+                continue;
+
+            int32_t other_end = std::min(other + block_size, dimension);
+            floyd_warshall_block(data, dimension, k, k_end, other, other_end, k, k_end);
+            floyd_warshall_block(data, dimension, other, other_end, k, k_end, k, k_end);
+        }
+
+        for(int32_t i = 0; i < dimension; i += block_size)
+        {
+            if(i == k)
+                continue;
+
+            int32_t i_end = std::min(i + block_size, dimension);
+            for(int32_t j = 0; j < dimension; j += block_size)
+                if(j != k)
+                    floyd_warshall_independent_block(data, dimension, i, i_end, j,
+                        std::min(j + block_size, dimension), k, k_end);
+        }
+    }
+
+    for(auto& value: matrix)
+        if(value > INF / 2)
+            value = INF;
+}
@@ -0,0 +1,214 @@
+/* This file implements heavy-light decomposition. */
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "csr_graph.cpp"
+#include "segment_tree.cpp"
+
+/*
+ * Heavy-light decomposition of a tree.
+ *
+ * Every node has a heavy child (the one with the largest subtree). Nodes are
+ * laid out in DFS order that visits the heavy child first, so every heavy path
+ * occupies a contiguous range of positions, and so does every subtree. Any
+ * path crosses O(log n) heavy paths, so path queries and updates become
+ * O(log n) range operations on a segment tree, O(log^2 n) in total.
+ * All traversals are iterative.
+ *
+ * Path and subtree operations are delegated to Tree, by default
+ * RangeRangeSegmentTree<> (range add, range sum of int32_t). Any
+ * RangeRangeSegmentTree can be used, e.g. with int64_t sums or min with add,
+ * as long as its monoid is commutative: path segments are combined in
+ * arbitrary order. Other segment trees can be used through
+ * for_each_path_segment and 'position'.
+ *
+ * Variables
+ * ---------
+ * parent - parent of the node, parent of root is root
+ * depth - distance from the node to root
+ * subtree_size - number of nodes in subtree of the node
+ * heavy - heavy child of the node, -1 for leaves
+ * head - topmost node of the heavy path containing the node
+ * position - position of the node in the layout, in range [0, number of nodes)
+ *
+ * Examples
+ * --------
+ * std::vector<std::pair<int32_t, int32_t> > edges{{0, 1}, {0, 2}, {2, 3}, {2, 4}};
+ * CsrGraph tree(5, edges, true);
+ * HeavyLightDecomposition<> hld(tree, 0);
+ * hld.path_update(1, 4, 10);
+ * hld.subtree_update(2, 1);
+ * std::cout << hld.path_query(3, 1) << "\n";
+ * std::cout << hld.subtree_query(2) << "\n";
+ *
+ * HeavyLightDecomposition<RangeRangeSegmentTree<int64_t> > wide_hld(tree, 0);
+ * wide_hld.path_update(1, 4, 2'000'000'000);
+ * std::cout << wide_hld.path_query(1, 4) << "\n";
+ *
+ * HeavyLightDecomposition<RangeRangeSegmentTree<int64_t, MinMonoid<int64_t>,
+ *     AddExtremumAction<int64_t> > > min_hld(tree, 0);
+ * min_hld.path_update(3, 4, -5);
+ * std::cout << min_hld.path_query(1, 3) << "\n";
+ *
+ * RangePointSegmentTree<> point_tree(5);
+ * point_tree.insert(hld.position[3], 7);
+ * int32_t total = 0;
+ * hld.for_each_path_segment(3, 1, [&](int32_t lf, int32_t rt) { total += point_tree.query(lf, rt); });
+ */
+template<class Tree=RangeRangeSegmentTree<> >
+struct HeavyLightDecomposition
+{
+    typedef typename Tree::monoid_type monoid_type;
+    typedef typename Tree::value_type value_type;
+    typedef typename Tree::action_type action_type;
+
+    std::vector<int32_t> parent;
+    std::vector<int32_t> depth;
+    std::vector<int32_t> subtree_size;
+    std::vector<int32_t> heavy;
+    std::vector<int32_t> head;
+    std::vector<int32_t> position;
+    Tree segment_tree;
+
+    HeavyLightDecomposition(const CsrGraph& tree, int32_t root)
+        : parent(tree.number_of_nodes, -1), depth(tree.number_of_nodes, 0),
+        subtree_size(tree.number_of_nodes, 1), heavy(tree.number_of_nodes, -1),
+        head(tree.number_of_nodes, 0), position(tree.number_of_nodes, 0),
+        segment_tree(tree.number_of_nodes, value_type())
+    {
+        std::vector<int32_t> order{root};
+        order.reserve(tree.number_of_nodes);
+        parent[root] = root;
+        for(int32_t i = 0; i < (int32_t)order.size(); i++)
+        {
+            auto current = order[i];
+            for(int32_t j = tree.offsets[current]; j < tree.offsets[current+1]; j++)
+            {
+                auto child = tree.targets[j];
+                if(child == parent[current])
+                    continue;
+
+                parent[child] = current;
+                depth[child] = depth[current] + 1;
+                order.push_back(child);
+            }
+        }
+
+        for(int32_t i = order.size() - 1; i > 0; i--)
+        {
+            auto current = order[i];
+            subtree_size[parent[current]] += subtree_size[current];
+            if(heavy[parent[current]] == -1 || subtree_size[current] > subtree_size[heavy[parent[current]]])
+                heavy[parent[current]] = current;
+        }
+
+        std::vector<int32_t> stack{root};
+        head[root] = root;
+        for(int32_t next_position = 0; !stack.empty();)
+        {
+            auto current = stack.back();
+            stack.pop_back();
+            position[current] = next_position++;
+
+            for(int32_t j = tree.offsets[current]; j < tree.offsets[current+1]; j++)
+            {
+                auto child = tree.targets[j];
+                if(child == parent[current] || child == heavy[current])
+                    continue;
+
+                head[child] = child;
+                stack.push_back(child);
+            }
+
+            if(heavy[current] != -1)
+            {
+                head[heavy[current]] = head[current];
+                stack.push_back(heavy[current]);
+            }
+        }
+    }
+
+    /* Set initial values of nodes.
+     *
+     * Parameters
+     * ----------
+     * values - array with value of every node. Can be both vector<int> and int[]
+     */
+    template<class A>
+    void build_from_array(A& values)
+    {
+        std::vector<value_type> laid_out(position.size());
+        for(int32_t i = 0; i < (int32_t)position.size(); i++)
+            laid_out[position[i]] = values[i];
+
+        segment_tree.build_from_array(laid_out, laid_out.size());
+    }
+
+    /* Call 'function(lf, rt)' for every range of positions [lf, rt] (0-indexed,
+     * inclusive) that together cover path from 'a' to 'b'.
+     */
+    template<class F>
+    void for_each_path_segment(int32_t a, int32_t b, F function) const
+    {
+        while(head[a] != head[b])
+        {
+            if(depth[head[a]] < depth[head[b]])
+                std::swap(a, b);
+
+            function(position[head[a]], position[a]);
+            a = parent[head[a]];
+        }
+
+        if(depth[a] > depth[b])
+            std::swap(a, b);
+        function(position[a], position[b]);
+    }
+
+    int32_t lca(int32_t a, int32_t b) const
+    {
+        while(head[a] != head[b])
+        {
+            if(depth[head[a]] < depth[head[b]])
+                std::swap(a, b);
+            a = parent[head[a]];
+        }
+
+        return depth[a] < depth[b] ? a : b;
+    }
+
+    /* Apply 'value' to every node on path from 'a' to 'b'. */
+    void path_update(int32_t a, int32_t b, action_type value)
+    {
+        for_each_path_segment(a, b, [&](int32_t lf, int32_t rt)
+        {
+            segment_tree.insert(lf + 1, rt + 1, value);
+        });
+    }
+
+    /* Combination of values of nodes on path from 'a' to 'b'. */
+    value_type path_query(int32_t a, int32_t b) const
+    {
+        value_type result = monoid_type::identity();
+        for_each_path_segment(a, b, [&](int32_t lf, int32_t rt)
+        {
+            result = monoid_type::combine(result, segment_tree.query(lf + 1, rt + 1));
+        });
+
+        return result;
+    }
+
+    /* Apply 'value' to every node in subtree of 'node'. */
+    void subtree_update(int32_t node, action_type value)
+    {
+        segment_tree.insert(position[node] + 1, position[node] + subtree_size[node], value);
+    }
+
+    /* Combination of values of nodes in subtree of 'node'. */
+    value_type subtree_query(int32_t node) const
+    {
+        return segment_tree.query(position[node] + 1, position[node] + subtree_size[node]);
+    }
+};
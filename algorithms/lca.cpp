@@ -1,9 +1,60 @@
 /* This file implements LCA algorithm */
 
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 #include <iostream>
 
+#include "csr_graph.cpp"
+#include "dfs.cpp"
+#include "find_and_union.cpp"
+
+/* Calculate parent and depth of every node of a tree stored in CSR format
+ *
+ * Traversal is iterative, so it works for trees of any height.
+ *
+ * Parameters
+ * ----------
+ * tree - tree representation using CSR format. Every edge must be present in both directions
+ * root - root of the tree
+ * parents - array to store parent of every node. Parent of root is root. Can be both vector<int> and int[]
+ * depth - array to store depth of every node. Can be both vector<int> and int[]
+ *
+ * Examples
+ * --------
+ * std::vector<std::pair<int32_t, int32_t> > edges{{0, 1}, {0, 2}, {2, 3}, {2, 4}};
+ * CsrGraph tree(5, edges, true);
+ * std::vector<int32_t> parents(5), depth(5);
+ * calculate_parents(tree, 0, parents, depth);
+ * auto ancestors = calculate_ancestors(parents, 5);
+ */
+template<class T, class D>
+void calculate_parents(const CsrGraph& tree, int32_t root, T& parents, D& depth)
+{
+    std::vector<int32_t> order;
+    order.reserve(tree.number_of_nodes);
+
+    parents[root] = root;
+    depth[root] = 0;
+    order.push_back(root);
+
+    for(int32_t head = 0; head < (int32_t)order.size(); head++)
+    {
+        auto current = order[head];
+        for(int32_t i = tree.offsets[current]; i < tree.offsets[current+1]; i++)
+        {
+            auto child = tree.targets[i];
+            if(child == parents[current])
+                continue;
+
+            parents[child] = current;
+            depth[child] = depth[current] + 1;
+            order.push_back(child);
+        }
+    }
+}
+
+
 /* Calculate 1st, 2nd, 4th, 8th, 16th, 32th, ..., ancestor for each nodes
  *
  * Parameters
@@ -74,4 +125,297 @@ int32_t lca(int32_t a, int32_t b, T& depth, D& ancestors)
     }
 
     return ancestors[a][0];
-}
\ No newline at end of file
+}
+
+
+/*
+ * Binary lifting table for LCA stored in one flat, level-major array.
+ *
+ * up[k*number_of_nodes + v] is the 2^k-th ancestor of 'v', so each level is a
+ * contiguous block and building level k reads only level k-1. Number of levels
+ * is the smallest L with 2^L > height of the tree instead of a fixed 21, and
+ * depth is computed from parents as well.
+ *
+ * Parameters
+ * ----------
+ * parents - array of parents for each node in tree. Parent of root is root. Can be both vector<int> and int[]
+ * number_of_nodes - number of nodes in tree
+ *
+ * Examples
+ * --------
+ * vector<int> parents{0, 0, 0, 2, 2};
+ * BinaryLifting lifting(parents, parents.size());
+ * std::cout << lifting.lca(3, 4) << "\n";
+ * std::cout << lifting.lca(1, 4) << "\n";
+ */
+struct BinaryLifting
+{
+    int32_t number_of_nodes;
+    int32_t levels;
+    std::vector<int32_t> depth;
+    std::vector<int32_t> up;
+
+    template<class T>
+    BinaryLifting(T& parents, int32_t number_of_nodes)
+        : number_of_nodes(number_of_nodes), levels(1), depth(number_of_nodes, -1)
+    {
+        std::vector<int32_t> path;
+        int32_t max_depth = 0;
+        for(int32_t i = 0; i < number_of_nodes; i++)
+        {
+            auto current = i;
+            while(depth[current] == -1 && parents[current] != current)
+            {
+                path.push_back(current);
+                current = parents[current];
+            }
+            if(depth[current] == -1)
+                depth[current] = 0;
+
+            for(; !path.empty(); path.pop_back())
+                depth[path.back()] = depth[parents[path.back()]] + 1;
+            max_depth = std::max(max_depth, depth[i]);
+        }
+
+        while((1 << levels) <= max_depth)
+            levels++;
+
+        up.resize((int64_t)levels * number_of_nodes);
+        for(int32_t i = 0; i < number_of_nodes; i++)
+            up[i] = parents[i];
+
+        for(int32_t k = 1; k < levels; k++)
+        {
+            const int32_t* previous = up.data() + (int64_t)(k-1) * number_of_nodes;
+            int32_t* current = up.data() + (int64_t)k * number_of_nodes;
+            for(int32_t i = 0; i < number_of_nodes; i++)
+                current[i] = previous[previous[i]];
+        }
+    }
+
+    /* Ancestor of 'node' that is 'distance' levels above it (root if the tree is not that high). */
+    int32_t ancestor(int32_t node, int32_t distance) const
+    {
+        distance = std::min(distance, depth[node]);
+        for(int32_t k = 0; distance > 0; k++, distance >>= 1)
+            if(distance & 1)
+                node = up[(int64_t)k * number_of_nodes + node];
+
+        return node;
+    }
+
+    /* Calculate lca of 'a' and 'b'. */
+    int32_t lca(int32_t a, int32_t b) const
+    {
+        if (depth[b] < depth[a])
+            std::swap(a, b);
+
+        b = ancestor(b, depth[b] - depth[a]);
+        if (a == b)
+            return a;
+
+        for(int32_t k = levels - 1; k >= 0; k--)
+        {
+            const int32_t* level = up.data() + (int64_t)k * number_of_nodes;
+            if (level[a] != level[b])
+            {
+                a = level[a];
+                b = level[b];
+            }
+        }
+
+        return up[a];
+    }
+};
+
+
+/*
+ * LCA in O(1) per query with range minimum over DFS order.
+ *
+ * Variant of the Euler tour + RMQ method that uses DFS order of n nodes
+ * instead of Euler tour of 2n-1 nodes: for tin[a] < tin[b], lca(a, b) is the
+ * parent with the smallest tin among parents of nodes on preorder positions
+ * (tin[a], tin[b]]. Range minimum is answered with sparse table over blocks of
+ * 64 positions plus, inside a block, 64-bit masks of the monotonic stack of
+ * minima, so a query is a few array reads and bit operations with no loops.
+ * Preprocessing is O(n) plus O(n/64 log n) for the sparse table, and the DFS
+ * is iterative, so it works for trees of any height.
+ *
+ * Parameters
+ * ----------
+ * tree - tree representation using CSR format. Every edge must be present in both directions
+ * root - root of the tree
+ *
+ * Examples
+ * --------
+ * std::vector<std::pair<int32_t, int32_t> > edges{{0, 1}, {0, 2}, {2, 3}, {2, 4}};
+ * CsrGraph tree(5, edges, true);
+ * EulerTourLca lca_table(tree, 0);
+ * std::cout << lca_table.lca(3, 4) << "\n";
+ * std::cout << lca_table.lca(1, 4) << "\n";
+ */
+struct EulerTourLca
+{
+    std::vector<int32_t> tin;
+    std::vector<int32_t> preorder;
+    std::vector<int32_t> values;
+    std::vector<uint64_t> masks;
+    std::vector<int32_t> sparse;
+    int32_t number_of_blocks;
+
+    EulerTourLca(const CsrGraph& tree, int32_t root)
+    {
+        auto order = iterative_dfs(tree, root);
+        tin = std::move(order.tin);
+        preorder = std::move(order.preorder);
+
+        int32_t size = preorder.size();
+        values.resize(size);
+        values[0] = 0;
+        for(int32_t i = 1; i < size; i++)
+            values[i] = tin[order.parent[preorder[i]]];
+
+        masks.resize(size);
+        number_of_blocks = (size + 63) / 64;
+        int32_t levels = 1;
+        while((1 << levels) <= number_of_blocks)
+            levels++;
+        sparse.resize((int64_t)levels * number_of_blocks);
+
+        for(int32_t block = 0; block < number_of_blocks; block++)
+        {
+            int32_t begin = block * 64;
+            int32_t end = std::min(begin + 64, size);
+            uint64_t stack = 0;
+            for(int32_t i = begin; i < end; i++)
+            {
+                while(stack && values[begin + 63 - __builtin_clzll(stack)] >= values[i])
+                    stack ^= 1ULL << (63 - __builtin_clzll(stack));
+                stack |= 1ULL << (i - begin);
+                masks[i] = stack;
+            }
+            sparse[block] = values[begin + __builtin_ctzll(masks[end-1])];
+        }
+
+        for(int32_t k = 1; k < levels; k++)
+        {
+            const int32_t* previous = sparse.data() + (int64_t)(k-1) * number_of_blocks;
+            int32_t* current = sparse.data() + (int64_t)k * number_of_blocks;
+            for(int32_t i = 0; i + (1 << k) <= number_of_blocks; i++)
+                current[i] = std::min(previous[i], previous[i + (1 << (k-1))]);
+        }
+    }
+
+    /* Minimum of values[lf..rt], both in the same block. */
+    int32_t block_minimum(int32_t lf, int32_t rt) const
+    {
+        return values[(lf & ~63) + __builtin_ctzll(masks[rt] & (~0ULL << (lf & 63)))];
+    }
+
+    /* Minimum of values[lf..rt]. */
+    int32_t range_minimum(int32_t lf, int32_t rt) const
+    {
+        int32_t block_lf = lf >> 6, block_rt = rt >> 6;
+        if(block_lf == block_rt)
+            return block_minimum(lf, rt);
+
+        int32_t result = std::min(block_minimum(lf, block_lf * 64 + 63), block_minimum(block_rt * 64, rt));
+        if(block_lf + 1 < block_rt)
+        {
+            int32_t k = 31 - __builtin_clz(block_rt - block_lf - 1);
+            const int32_t* level = sparse.data() + (int64_t)k * number_of_blocks;
+            result = std::min(result, std::min(level[block_lf + 1], level[block_rt - (1 << k)]));
+        }
+
+        return result;
+    }
+
+    /* Calculate lca of 'a' and 'b'. */
+    int32_t lca(int32_t a, int32_t b) const
+    {
+        if(a == b)
+            return a;
+
+        int32_t lf = std::min(tin[a], tin[b]) + 1, rt = std::max(tin[a], tin[b]);
+        return preorder[range_minimum(lf, rt)];
+    }
+};
+
+
+/*
+ * Tarjan's offline LCA algorithm for a batch of queries.
+ *
+ * Nodes are processed in DFS postorder. When node 'u' is finished, every query
+ * (u, w) whose other end 'w' is already finished is answered with the stored
+ * ancestor of FIND(w), and then 'u' is united with its parent. Together with
+ * union by size and path compression from find_and_union.cpp the whole batch
+ * runs in near-linear time. Queries are grouped by node in two counting
+ * passes, and the DFS is iterative.
+ *
+ * Parameters
+ * ----------
+ * tree - tree representation using CSR format. Every edge must be present in both directions
+ * root - root of the tree
+ * queries - pairs of nodes to find lca for
+ *
+ * Returns
+ * -------
+ * lca of every query, in the order of 'queries'
+ *
+ * Examples
+ * --------
+ * std::vector<std::pair<int32_t, int32_t> > edges{{0, 1}, {0, 2}, {2, 3}, {2, 4}};
+ * CsrGraph tree(5, edges, true);
+ * std::vector<std::pair<int32_t, int32_t> > queries{{3, 4}, {1, 4}};
+ * auto answers = offline_lca(tree, 0, queries);
+ */
+std::vector<int32_t> offline_lca(const CsrGraph& tree, int32_t root,
+    const std::vector<std::pair<int32_t, int32_t> >& queries)
+{
+    int32_t number_of_nodes = tree.number_of_nodes;
+    std::vector<int32_t> query_offsets(number_of_nodes+1, 0);
+    for(auto& query: queries)
+    {
+        query_offsets[query.first+1]++;
+        query_offsets[query.second+1]++;
+    }
+    for(int32_t i = 0; i < number_of_nodes; i++)
+        query_offsets[i+1] += query_offsets[i];
+
+    std::vector<int32_t> query_ids(query_offsets[number_of_nodes]);
+    std::vector<int32_t> cursor(query_offsets.begin(), query_offsets.end()-1);
+    for(int32_t i = 0; i < (int32_t)queries.size(); i++)
+    {
+        query_ids[cursor[queries[i].first]++] = i;
+        query_ids[cursor[queries[i].second]++] = i;
+    }
+
+    std::vector<int32_t> leader(number_of_nodes), group_size(number_of_nodes, 1);
+    std::vector<int32_t> ancestor(number_of_nodes);
+    std::vector<bool> finished(number_of_nodes, false);
+    for(int32_t i = 0; i < number_of_nodes; i++)
+        leader[i] = ancestor[i] = i;
+
+    std::vector<int32_t> answers(queries.size(), -1);
+    auto order = iterative_dfs(tree, root);
+    for(auto node: order.postorder)
+    {
+        finished[node] = true;
+        for(int32_t i = query_offsets[node]; i < query_offsets[node+1]; i++)
+        {
+            auto& query = queries[query_ids[i]];
+            auto other = (query.first == node ? query.second : query.first);
+            if(finished[other])
+                answers[query_ids[i]] = ancestor[FIND(other, leader)];
+        }
+
+        auto parent = order.parent[node];
+        if(parent != node)
+        {
+            UNION(parent, node, leader, group_size);
+            ancestor[FIND(parent, leader)] = parent;
+        }
+    }
+
+    return answers;
+}
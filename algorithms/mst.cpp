@@ -0,0 +1,318 @@
+/* This file implements minimum spanning tree algorithms. */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "bellman_ford.cpp"
+#include "find_and_union.cpp"
+
+/* Run 'function(begin, end, thread_index)' on 'number_of_threads' contiguous chunks of [0, count). */
+template<class F>
+void parallel_chunks(int64_t count, int32_t number_of_threads, F function)
+{
+    number_of_threads = std::max<int64_t>(1, std::min<int64_t>(number_of_threads, count));
+    std::vector<std::thread> threads;
+    for(int32_t i = 1; i < number_of_threads; i++)
+        threads.emplace_back(function, count * i / number_of_threads,
+            count * (i+1) / number_of_threads, i);
+    function(0, count / number_of_threads, 0);
+    for(auto& thread: threads)
+        thread.join();
+}
+
+/*
+ * Multi-threaded sort.
+ *
+ * Contiguous chunks are sorted on separate threads, then neighbouring sorted
+ * runs are merged pairwise, also in parallel, until one run is left.
+ *
+ * Parameters
+ * ----------
+ * values - vector to sort
+ * compare - comparator, as in std::sort
+ * number_of_threads - number of threads to use
+ *
+ * Examples
+ * --------
+ * std::vector<Edge> edges = {{0, 1, 5}, {1, 2, 3}};
+ * parallel_sort(edges, [](const Edge& a, const Edge& b) { return a.cost < b.cost; }, 4);
+ */
+template<class T, class Compare>
+void parallel_sort(std::vector<T>& values, Compare compare,
+    int32_t number_of_threads=std::thread::hardware_concurrency())
+{
+    int64_t size = values.size();
+    number_of_threads = std::max<int64_t>(1, std::min<int64_t>(number_of_threads, size / (1 << 14)));
+    std::vector<int64_t> bounds(number_of_threads+1);
+    for(int32_t i = 0; i <= number_of_threads; i++)
+        bounds[i] = size * i / number_of_threads;
+
+    parallel_chunks(number_of_threads, number_of_threads, [&](int64_t begin, int64_t end, int32_t)
+    {
+        for(auto chunk = begin; chunk < end; chunk++)
+            std::sort(values.begin() + bounds[chunk], values.begin() + bounds[chunk+1], compare);
+    });
+
+    for(int32_t width = 1; width < number_of_threads; width *= 2)
+    {
+        int32_t number_of_merges = (number_of_threads + 2*width - 1) / (2*width);
+        parallel_chunks(number_of_merges, number_of_merges, [&](int64_t begin, int64_t end, int32_t)
+        {
+            for(auto merge = begin; merge < end; merge++)
+            {
+                int32_t first = 2 * width * merge;
+                int32_t middle = std::min(first + width, (int32_t)number_of_threads);
+                int32_t last = std::min(first + 2*width, (int32_t)number_of_threads);
+                std::inplace_merge(values.begin() + bounds[first], values.begin() + bounds[middle],
+                    values.begin() + bounds[last], compare);
+            }
+        });
+    }
+}
+
+/*
+ * Kruskal's algorithm.
+ *
+ * Edges are sorted by cost with parallel_sort and added in this order if
+ * they connect two different components of DisjointSetUnion.
+ * O(E log E / threads + E alpha(V)).
+ *
+ * Parameters
+ * ----------
+ * number_of_nodes - number of nodes in the graph
+ * edges - undirected edges of the graph
+ * number_of_threads - number of threads used for sorting
+ *
+ * Returns
+ * -------
+ * edges of minimum spanning forest (spanning tree if the graph is connected)
+ *
+ * Examples
+ * --------
+ * std::vector<Edge> edges = {{0, 1, 4}, {1, 2, 1}, {0, 2, 2}};
+ * int64_t total = 0;
+ * for(auto& edge: kruskal(3, edges))
+ *     total += edge.cost;
+ */
+std::vector<Edge> kruskal(int32_t number_of_nodes, const std::vector<Edge>& edges,
+    int32_t number_of_threads=std::thread::hardware_concurrency())
+{
+    std::vector<Edge> sorted = edges;
+    parallel_sort(sorted, [](const Edge& a, const Edge& b) { return a.cost < b.cost; }, number_of_threads);
+
+    DisjointSetUnion dsu(number_of_nodes);
+    std::vector<Edge> result;
+    for(auto& edge: sorted)
+    {
+        if(dsu.unite(edge.from, edge.to))
+        {
+            result.push_back(edge);
+            if((int32_t)result.size() == number_of_nodes - 1)
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*
+ * Filter-Kruskal algorithm.
+ *
+ * Like quicksort, edges are partitioned around a pivot cost. Lighter part is
+ * processed first, then heavier edges whose ends are already connected are
+ * filtered out before the heavier part is processed. On graphs much denser
+ * than a tree most heavy edges are dropped without ever being sorted.
+ * Parts not larger than 'number_of_nodes' (or 2^16) edges are sorted with
+ * parallel_sort and run through plain Kruskal's algorithm.
+ *
+ * Parameters
+ * ----------
+ * number_of_nodes - number of nodes in the graph
+ * edges - undirected edges of the graph
+ * number_of_threads - number of threads used for sorting
+ *
+ * Returns
+ * -------
+ * edges of minimum spanning forest (spanning tree if the graph is connected)
+ */
+std::vector<Edge> filter_kruskal(int32_t number_of_nodes, const std::vector<Edge>& edges,
+    int32_t number_of_threads=std::thread::hardware_concurrency())
+{
+    std::vector<Edge> remaining = edges;
+    DisjointSetUnion dsu(number_of_nodes);
+    std::vector<Edge> result;
+    int64_t threshold = std::max(number_of_nodes, 1 << 16);
+    auto by_cost = [](const Edge& a, const Edge& b) { return a.cost < b.cost; };
+
+    auto base_case = [&](std::vector<Edge>& part)
+    {
+        parallel_sort(part, by_cost, number_of_threads);
+        for(auto& edge: part)
+            if(dsu.unite(edge.from, edge.to))
+                result.push_back(edge);
+    };
+
+    auto filter = [&](std::vector<Edge>& part)
+    {
+        part.erase(std::remove_if(part.begin(), part.end(),
+            [&](const Edge& edge) { return dsu.same(edge.from, edge.to); }), part.end());
+    };
+
+    // Parts waiting to be processed, the lightest one on top.
+    std::vector<std::vector<Edge> > parts;
+    parts.push_back(std::move(remaining));
+    while(!parts.empty() && (int32_t)result.size() < number_of_nodes - 1)
+    {
+        auto part = std::move(parts.back());
+        parts.pop_back();
+        filter(part);
+        if((int64_t)part.size() <= threshold)
+        {
+            base_case(part);
+            continue;
+        }
+
+        auto first = part[0].cost, middle = part[part.size()/2].cost, last = part.back().cost;
+        auto pivot = std::max(std::min(first, middle), std::min(std::max(first, middle), last));
+        auto split = std::partition(part.begin(), part.end(),
+            [&](const Edge& edge) { return edge.cost <= pivot; });
+        if(split == part.end())
+            split = std::partition(part.begin(), part.end(),
+                [&](const Edge& edge) { return edge.cost < pivot; });
+        if(split == part.begin())
+        {
+            // All remaining costs are equal to pivot
+            base_case(part);
+            continue;
+        }
+
+        parts.emplace_back(split, part.end());
+        part.resize(split - part.begin());
+        parts.push_back(std::move(part));
+    }
+
+    return result;
+}
+
+/*
+ * Multi-threaded Boruvka's algorithm.
+ *
+ * In every round each component picks its cheapest outgoing edge, all picked
+ * edges are added at once and components are merged, so the number of
+ * components at least halves per round, O(log V) rounds. Edges are compared
+ * by (cost, index), which makes the picked edges acyclic even with equal costs.
+ *
+ * All phases are parallel: threads scan chunks of live edges and keep the
+ * cheapest edge of every component in atomic 64-bit word (cost in high half,
+ * edge index in low half) updated with compare-and-swap, then merge picked
+ * edges in ConcurrentDisjointSetUnion and relabel nodes. Edges inside a single
+ * component are dropped from later rounds.
+ *
+ * Parameters
+ * ----------
+ * number_of_nodes - number of nodes in the graph
+ * edges - undirected edges of the graph
+ * number_of_threads - number of threads to use
+ *
+ * Returns
+ * -------
+ * edges of minimum spanning forest (spanning tree if the graph is connected)
+ *
+ * Examples
+ * --------
+ * std::vector<Edge> edges = {{0, 1, 4}, {1, 2, 1}, {0, 2, 2}};
+ * auto tree = boruvka(3, edges, 8);
+ */
+std::vector<Edge> boruvka(int32_t number_of_nodes, const std::vector<Edge>& edges,
+    int32_t number_of_threads=std::thread::hardware_concurrency())
+{
+    const uint64_t NONE = UINT64_MAX;
+    number_of_threads = std::max(number_of_threads, 1);
+
+    ConcurrentDisjointSetUnion dsu(number_of_nodes);
+    std::vector<int32_t> component(number_of_nodes);
+    std::vector<std::atomic<uint64_t> > cheapest(number_of_nodes);
+    parallel_chunks(number_of_nodes, number_of_threads, [&](int64_t begin, int64_t end, int32_t)
+    {
+        for(auto node = begin; node < end; node++)
+        {
+            component[node] = node;
+            cheapest[node].store(NONE, std::memory_order_relaxed);
+        }
+    });
+
+    auto update_cheapest = [&](int32_t node, uint64_t key)
+    {
+        auto current = cheapest[node].load(std::memory_order_relaxed);
+        while(key < current && !cheapest[node].compare_exchange_weak(current, key, std::memory_order_relaxed));
+    };
+
+    std::vector<uint32_t> live(edges.size());
+    parallel_chunks(edges.size(), number_of_threads, [&](int64_t begin, int64_t end, int32_t)
+    {
+        for(auto i = begin; i < end; i++)
+            live[i] = i;
+    });
+
+    std::vector<Edge> result;
+    std::vector<std::vector<uint32_t> > local_live(number_of_threads);
+    std::vector<std::vector<Edge> > local_result(number_of_threads);
+    while(!live.empty())
+    {
+        parallel_chunks(live.size(), number_of_threads, [&](int64_t begin, int64_t end, int32_t thread)
+        {
+            auto& kept = local_live[thread];
+            for(auto i = begin; i < end; i++)
+            {
+                auto& edge = edges[live[i]];
+                auto a = component[edge.from], b = component[edge.to];
+                if(a == b)
+                    continue;
+
+                uint64_t key = (uint64_t)((uint32_t)edge.cost ^ 0x80000000u) << 32 | live[i];
+                update_cheapest(a, key);
+                update_cheapest(b, key);
+                kept.push_back(live[i]);
+            }
+        });
+
+        live.clear();
+        for(auto& kept: local_live)
+        {
+            // Threads beyond live.size() do not run, so clear buffers here.
+            live.insert(live.end(), kept.begin(), kept.end());
+            kept.clear();
+        }
+        if(live.empty())
+            break;
+
+        parallel_chunks(number_of_nodes, number_of_threads, [&](int64_t begin, int64_t end, int32_t thread)
+        {
+            for(auto node = begin; node < end; node++)
+            {
+                auto key = cheapest[node].load(std::memory_order_relaxed);
+                if(key == NONE)
+                    continue;
+
+                cheapest[node].store(NONE, std::memory_order_relaxed);
+                auto& edge = edges[(uint32_t)key];
+                if(dsu.unite(edge.from, edge.to))
+                    local_result[thread].push_back(edge);
+            }
+        });
+
+        parallel_chunks(number_of_nodes, number_of_threads, [&](int64_t begin, int64_t end, int32_t)
+        {
+            for(auto node = begin; node < end; node++)
+                component[node] = dsu.find(node);
+        });
+    }
+
+    for(auto& picked: local_result)
+        result.insert(result.end(), picked.begin(), picked.end());
+
+    return result;
+}